@@ -0,0 +1,189 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "CompiledMappingCache.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <log/Logger.h>
+#include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib {
+
+    static constexpr char cacheMagic[8] = {'M', 'Q', 'S', 'M', 'A', 'P', 'C', '\0'};
+
+    std::uint64_t CompiledMappingCache::hash(const std::string& mappingContent, const std::string& schemaContent) {
+        // FNV-1a 64
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+        auto feed = [&hash](const std::string& content) {
+            for (const char c : content) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 0x100000001b3ULL;
+            }
+            hash ^= 0xff; // Separator, so that moving bytes between the two inputs changes the hash
+            hash *= 0x100000001b3ULL;
+        };
+
+        feed(mappingContent);
+        feed(schemaContent);
+
+        return hash;
+    }
+
+    std::string CompiledMappingCache::getCachePath(const std::string& mapFilePath) {
+        return mapFilePath + ".compiled";
+    }
+
+    bool CompiledMappingCache::load(const std::string& cachePath,
+                                    std::uint64_t contentHash,
+                                    nlohmann::json& mappingJson,
+                                    nlohmann::json& mappingJsonUnpatched) {
+        const int fd = ::open(cachePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            VLOG(1) << "Compiled mapping cache: No cache file '" << cachePath << "'";
+            return false;
+        }
+
+        bool success = false;
+
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Header)) {
+            const std::size_t fileSize = static_cast<std::size_t>(st.st_size);
+
+            void* map = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                const unsigned char* bytes = static_cast<const unsigned char*>(map);
+
+                Header header{};
+                std::memcpy(&header, bytes, sizeof(Header));
+
+                if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.formatVersion != formatVersion) {
+                    VLOG(1) << "Compiled mapping cache: Unknown format in '" << cachePath << "'";
+                } else if (header.contentHash != contentHash) {
+                    VLOG(1) << "Compiled mapping cache: Stale cache '" << cachePath << "'";
+                } else if (header.payloadSize != fileSize - sizeof(Header)) {
+                    VLOG(1) << "Compiled mapping cache: Truncated cache '" << cachePath << "'";
+                } else {
+                    try {
+                        nlohmann::json plan = nlohmann::json::from_cbor(bytes + sizeof(Header), bytes + fileSize);
+
+                        mappingJson = std::move(plan["mapping"]);
+                        mappingJsonUnpatched = std::move(plan["unpatched"]);
+
+                        success = true;
+
+                        VLOG(1) << "Compiled mapping cache: Hit '" << cachePath << "'";
+                    } catch (const std::exception& e) {
+                        VLOG(1) << "Compiled mapping cache: Corrupt cache '" << cachePath << "': " << e.what();
+                    }
+                }
+
+                ::munmap(map, fileSize);
+            } else {
+                VLOG(1) << "Compiled mapping cache: Mapping '" << cachePath << "' failed: " << std::strerror(errno);
+            }
+        }
+
+        ::close(fd);
+
+        return success;
+    }
+
+    bool CompiledMappingCache::store(const std::string& cachePath,
+                                     std::uint64_t contentHash,
+                                     const nlohmann::json& mappingJson,
+                                     const nlohmann::json& mappingJsonUnpatched) {
+        bool success = false;
+
+        try {
+            const std::vector<std::uint8_t> payload =
+                nlohmann::json::to_cbor({{"mapping", mappingJson}, {"unpatched", mappingJsonUnpatched}});
+
+            Header header{};
+            std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+            header.formatVersion = formatVersion;
+            header.contentHash = contentHash;
+            header.payloadSize = payload.size();
+
+            // Write to a temporary file and rename, so that a concurrently starting instance never maps a partially written cache
+            const std::string tmpPath = cachePath + ".tmp";
+
+            std::ofstream cacheFile(tmpPath, std::ios::binary | std::ios::trunc);
+            if (cacheFile.is_open()) {
+                cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+                cacheFile.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+                cacheFile.close();
+
+                if (cacheFile && std::rename(tmpPath.c_str(), cachePath.c_str()) == 0) {
+                    success = true;
+
+                    VLOG(1) << "Compiled mapping cache: Stored '" << cachePath << "'";
+                } else {
+                    std::remove(tmpPath.c_str());
+
+                    VLOG(1) << "Compiled mapping cache: Writing '" << cachePath << "' failed";
+                }
+            } else {
+                VLOG(1) << "Compiled mapping cache: Cannot open '" << tmpPath << "' for writing";
+            }
+        } catch (const std::exception& e) {
+            VLOG(1) << "Compiled mapping cache: Encoding failed: " << e.what();
+        }
+
+        return success;
+    }
+
+} // namespace mqtt::lib
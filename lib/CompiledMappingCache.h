@@ -0,0 +1,89 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTT_LIB_COMPILEDMAPPINGCACHE_H
+#define MQTT_LIB_COMPILEDMAPPINGCACHE_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstdint>
+#include <nlohmann/json_fwd.hpp> // IWYU pragma: export
+#include <string>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib {
+
+    // Binary cache of a validated and default-patched mapping. The cache file starts with a fixed header carrying a format version and
+    // a content hash of the mapping file and the mapping schema, followed by the CBOR encoded plan. A mismatching header is a cache miss.
+    class CompiledMappingCache {
+    public:
+        CompiledMappingCache() = delete;
+
+        static std::uint64_t hash(const std::string& mappingContent, const std::string& schemaContent);
+
+        static std::string getCachePath(const std::string& mapFilePath);
+
+        static bool load(const std::string& cachePath,
+                         std::uint64_t contentHash,
+                         nlohmann::json& mappingJson,
+                         nlohmann::json& mappingJsonUnpatched);
+        static bool store(const std::string& cachePath,
+                          std::uint64_t contentHash,
+                          const nlohmann::json& mappingJson,
+                          const nlohmann::json& mappingJsonUnpatched);
+
+    private:
+        struct Header {
+            char magic[8];
+            std::uint32_t formatVersion;
+            std::uint32_t reserved;
+            std::uint64_t contentHash;
+            std::uint64_t payloadSize;
+        };
+
+        static constexpr std::uint32_t formatVersion = 1;
+    };
+
+} // namespace mqtt::lib
+
+#endif // MQTT_LIB_COMPILEDMAPPINGCACHE_H
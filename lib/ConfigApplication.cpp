@@ -41,17 +41,20 @@
 
 #include "ConfigApplication.h"
 
+#include "CompiledMappingCache.h"
 #include "MqttMapper.h"
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 #include "log/Logger.h"
 
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iterator>
 #include <map>
 #include <stdexcept>
+#include <string>
 //
 #include <nlohmann/json_fwd.hpp>
 
@@ -82,6 +85,15 @@ namespace mqtt::lib {
                   "MQTT mapping file (json format) for integration",
                   "filename",
                   !CLI::ExistingDirectory))
+        , mappingCacheSizeOpt(   //
+              addOptionFunction( //
+                  "--mqtt-mapping-cache-size",
+                  [this](const std::string& cacheSize) {
+                      mqttMapper->setRenderCacheCapacity(std::stoul(cacheSize));
+                  },
+                  "Number of rendered template mappings kept in the LRU render cache (0 = disabled)",
+                  "size",
+                  CLI::NonNegativeNumber))
         , sessionStoreOpt( //
               addOption(   //
                   "--mqtt-session-store",
@@ -159,10 +171,22 @@ namespace mqtt::lib {
 
             if (mapFile.is_open()) {
                 try {
-                    mustReconnect = setMapping({std::istreambuf_iterator<char>(mapFile), std::istreambuf_iterator<char>()});
-
+                    const std::string mappingContent{std::istreambuf_iterator<char>(mapFile), std::istreambuf_iterator<char>()};
                     mapFile.close();
 
+                    const std::uint64_t contentHash = CompiledMappingCache::hash(mappingContent, MqttMapper::getSchema());
+                    const std::string cachePath = CompiledMappingCache::getCachePath(mapFilename);
+
+                    nlohmann::json compiledMappingJson;
+                    nlohmann::json compiledMappingJsonUnpatched;
+                    if (CompiledMappingCache::load(cachePath, contentHash, compiledMappingJson, compiledMappingJsonUnpatched)) {
+                        mustReconnect = mqttMapper->setCompiledMapping(compiledMappingJson, compiledMappingJsonUnpatched);
+                    } else {
+                        mustReconnect = setMapping(mappingContent);
+
+                        CompiledMappingCache::store(cachePath, contentHash, mqttMapper->getCompiledMapping(), mqttMapper->getMapping());
+                    }
+
                     VLOG(1) << "Load mapping file success";
                 } catch (const std::exception& e) {
                     mapFile.close();
@@ -189,7 +213,54 @@ namespace mqtt::lib {
                   "--html-root",
                   "HTML root directory",
                   "directory",
-                  CLI::ExistingDirectory)) {
+                  CLI::ExistingDirectory))
+        , mappingMaxChainDepthOpt( //
+              addOption(           //
+                  "--mqtt-mapping-max-chain-depth",
+                  "Maximum number of consecutive immediate mappings triggered by one publish",
+                  "depth",
+                  "16",
+                  CLI::PositiveNumber))
+        , sysIntervalOpt( //
+              addOption(  //
+                  "--mqtt-sys-interval",
+                  "Interval in seconds of the $SYS/broker statistics topics (0 disables them)",
+                  "seconds",
+                  "10",
+                  CLI::NonNegativeNumber))
+        , workersOpt(    //
+              addOption( //
+                  "--mqtt-workers",
+                  "Number of broker processes sharing the MQTT listeners via SO_REUSEPORT",
+                  "count",
+                  "1",
+                  CLI::PositiveNumber))
+        , retainedStoreOpt( //
+              addOption(    //
+                  "--mqtt-retained-store",
+                  "Base path of the retained message store (write-ahead logs and snapshot)",
+                  "path",
+                  !CLI::ExistingDirectory))
+        , sharedSubscriptionStrategyOpt( //
+              addOption(                 //
+                  "--mqtt-shared-subscription-strategy",
+                  "Selection of the member of a $share group receiving a message",
+                  "strategy",
+                  "round-robin",
+                  CLI::IsMember({"round-robin", "sticky"})))
+        , handoffSocketOpt( //
+              addOption(    //
+                  "--mqtt-handoff-socket",
+                  "Control socket used to hand over the listeners to a newly started broker",
+                  "path",
+                  !CLI::ExistingDirectory))
+        , handoffDrainRateOpt( //
+              addOption(       //
+                  "--mqtt-handoff-drain-rate",
+                  "Number of clients disconnected per second after the listeners have been handed over",
+                  "clients",
+                  "100",
+                  CLI::PositiveNumber)) {
         required(htmlRootOpt);
     }
 
@@ -208,6 +279,76 @@ namespace mqtt::lib {
         return htmlRootOpt->as<std::string>();
     }
 
+    ConfigMqttBroker& ConfigMqttBroker::setMappingMaxChainDepth(std::size_t maxChainDepth) {
+        setDefaultValue(mappingMaxChainDepthOpt, maxChainDepth);
+
+        return *this;
+    }
+
+    std::size_t ConfigMqttBroker::getMappingMaxChainDepth() const {
+        return mappingMaxChainDepthOpt->as<std::size_t>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setSysInterval(std::size_t sysInterval) {
+        setDefaultValue(sysIntervalOpt, sysInterval);
+
+        return *this;
+    }
+
+    std::size_t ConfigMqttBroker::getSysInterval() const {
+        return sysIntervalOpt->as<std::size_t>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setWorkers(std::size_t workers) {
+        setDefaultValue(workersOpt, workers);
+
+        return *this;
+    }
+
+    std::size_t ConfigMqttBroker::getWorkers() const {
+        return workersOpt->as<std::size_t>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setRetainedStore(const std::string& retainedStore) {
+        setDefaultValue(retainedStoreOpt, retainedStore);
+
+        return *this;
+    }
+
+    std::string ConfigMqttBroker::getRetainedStore() const {
+        return retainedStoreOpt->as<std::string>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setSharedSubscriptionStrategy(const std::string& strategy) {
+        setDefaultValue(sharedSubscriptionStrategyOpt, strategy);
+
+        return *this;
+    }
+
+    std::string ConfigMqttBroker::getSharedSubscriptionStrategy() const {
+        return sharedSubscriptionStrategyOpt->as<std::string>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setHandoffSocket(const std::string& handoffSocket) {
+        setDefaultValue(handoffSocketOpt, handoffSocket);
+
+        return *this;
+    }
+
+    std::string ConfigMqttBroker::getHandoffSocket() const {
+        return handoffSocketOpt->as<std::string>();
+    }
+
+    ConfigMqttBroker& ConfigMqttBroker::setHandoffDrainRate(std::size_t drainRate) {
+        setDefaultValue(handoffDrainRateOpt, drainRate);
+
+        return *this;
+    }
+
+    std::size_t ConfigMqttBroker::getHandoffDrainRate() const {
+        return handoffDrainRateOpt->as<std::size_t>();
+    }
+
     ConfigMqttIntegrator::ConfigMqttIntegrator(utils::SubCommand* parent)
         : ConfigApplication(parent, this) {
     }
@@ -50,6 +50,7 @@ namespace mqtt::lib {
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -82,6 +83,7 @@ namespace mqtt::lib {
         std::shared_ptr<MqttMapper> mqttMapper;
 
         CLI::Option* mappingFileOpt;
+        CLI::Option* mappingCacheSizeOpt;
         CLI::Option* sessionStoreOpt;
 
     private:
@@ -100,8 +102,36 @@ namespace mqtt::lib {
         ConfigMqttBroker& setHtmlRoot(const std::string& htmlRoot);
         std::string getHtmlRoot();
 
+        ConfigMqttBroker& setMappingMaxChainDepth(std::size_t maxChainDepth);
+        std::size_t getMappingMaxChainDepth() const;
+
+        ConfigMqttBroker& setSysInterval(std::size_t sysInterval);
+        std::size_t getSysInterval() const;
+
+        ConfigMqttBroker& setWorkers(std::size_t workers);
+        std::size_t getWorkers() const;
+
+        ConfigMqttBroker& setRetainedStore(const std::string& retainedStore);
+        std::string getRetainedStore() const;
+
+        ConfigMqttBroker& setSharedSubscriptionStrategy(const std::string& strategy);
+        std::string getSharedSubscriptionStrategy() const;
+
+        ConfigMqttBroker& setHandoffSocket(const std::string& handoffSocket);
+        std::string getHandoffSocket() const;
+
+        ConfigMqttBroker& setHandoffDrainRate(std::size_t drainRate);
+        std::size_t getHandoffDrainRate() const;
+
     private:
         CLI::Option* htmlRootOpt;
+        CLI::Option* mappingMaxChainDepthOpt;
+        CLI::Option* sysIntervalOpt;
+        CLI::Option* workersOpt;
+        CLI::Option* retainedStoreOpt;
+        CLI::Option* sharedSubscriptionStrategyOpt;
+        CLI::Option* handoffSocketOpt;
+        CLI::Option* handoffDrainRateOpt;
     };
 
     class ConfigMqttIntegrator : public ConfigApplication {
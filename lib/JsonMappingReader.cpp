@@ -52,6 +52,7 @@
 #include <algorithm>
 #include <chrono>
 #include <compare>
+#include <cstddef>
 #include <ctime>
 #include <exception>
 #include <filesystem>
@@ -61,6 +62,8 @@
 #include <map>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <system_error>
 
 #endif
 
@@ -129,38 +132,12 @@ namespace mqtt::lib {
             VLOG(1) << "Failed to inject metadata into draft: " << e.what();
         }
 
-        // 2. Backup current active file
+        // 2. Backup current active file into the version store
         if (fs::exists(mapFilePath)) {
-            fs::path versionDir = fs::path(mapFilePath).parent_path() / "versions";
-            if (!fs::exists(versionDir)) {
-                fs::create_directories(versionDir);
-            }
-
             auto now = std::chrono::system_clock::now();
             auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-            std::string filename = fs::path(mapFilePath).filename().string();
-            std::string backupPath = versionDir / (filename + "." + std::to_string(timestamp));
-
-            fs::copy_file(mapFilePath, backupPath, fs::copy_options::overwrite_existing);
 
-            // 3. Prune old versions (Keep last 50)
-            try {
-                std::vector<fs::path> versions;
-                for (const auto& entry : fs::directory_iterator(versionDir)) {
-                    if (entry.path().filename().string().starts_with(filename + ".")) {
-                        versions.push_back(entry.path());
-                    }
-                }
-                if (versions.size() > 50) {
-                    std::sort(versions.begin(), versions.end(), [](const fs::path& a, const fs::path& b) {
-                        return fs::last_write_time(a) < fs::last_write_time(b); // Oldest first
-                    });
-                    for (size_t i = 0; i < versions.size() - 50; ++i) {
-                        fs::remove(versions[i]);
-                    }
-                }
-            } catch (...) {
-            }
+            storeVersion(mapFilePath, std::to_string(timestamp));
         }
 
         // 4. Erase draft file
@@ -176,85 +153,255 @@ namespace mqtt::lib {
         }
     }
 
-    std::vector<JsonMappingReader::VersionEntry> JsonMappingReader::getHistory(const std::string& mapFilePath) {
-        std::vector<VersionEntry> history;
-        fs::path versionDir = fs::path(mapFilePath).parent_path() / "versions";
-        std::string baseName = fs::path(mapFilePath).filename().string();
+    static std::string formatTimestamp(const std::string& id) {
+        try {
+            std::time_t t = static_cast<std::time_t>(std::stoll(id));
+            std::stringstream ss;
+            ss << std::put_time(std::gmtime(&t), "%Y-%m-%dT%H:%M:%SZ");
+            return ss.str();
+        } catch (...) {
+            return "Unknown";
+        }
+    }
+
+    static fs::path getVersionDir(const std::string& mapFilePath) {
+        return fs::path(mapFilePath).parent_path() / "versions";
+    }
+
+    static nlohmann::json readJsonFile(const std::string& path) {
+        std::ifstream f(path);
+        if (!f) {
+            throw std::runtime_error("Cannot open version file: " + path);
+        }
+        nlohmann::json j;
+        f >> j;
+        return j;
+    }
 
-        if (!fs::exists(versionDir))
-            return history;
+    std::vector<JsonMappingReader::VersionEntry> JsonMappingReader::readVersionIndex(const std::string& mapFilePath) {
+        std::vector<VersionEntry> index;
 
-        for (const auto& entry : fs::directory_iterator(versionDir)) {
-            if (entry.path().filename().string().starts_with(baseName + ".")) {
-                VersionEntry v;
-                v.filename = entry.path().string();
-                // Extract ID (timestamp) from filename extension
-                v.id = entry.path().extension().string().substr(1);
+        fs::path versionDir = getVersionDir(mapFilePath);
+        std::string baseName = fs::path(mapFilePath).filename().string();
+        fs::path indexPath = versionDir / (baseName + ".index");
 
-                // Peek inside JSON to get the comment
+        if (fs::exists(indexPath)) {
+            std::ifstream f(indexPath);
+            std::string line;
+            while (std::getline(f, line)) {
                 try {
-                    std::ifstream f(v.filename);
-                    nlohmann::json j;
-                    f >> j;
-                    if (j.contains("meta")) {
-                        if (j["meta"].contains("comment"))
-                            v.comment = j["meta"]["comment"];
-                        if (j["meta"].contains("created"))
-                            v.date = j["meta"]["created"];
-                    }
-                } catch (...) {
+                    nlohmann::json e = nlohmann::json::parse(line);
+
+                    VersionEntry v;
+                    v.id = e.value("id", "");
+                    v.comment = e.value("comment", "");
+                    v.date = e.value("date", "");
+                    v.checkpoint = e.value("checkpoint", true);
+                    v.filename = (versionDir / (baseName + "." + v.id + (v.checkpoint ? "" : ".patch"))).string();
+
+                    index.push_back(v);
+                } catch (const std::exception& e) {
+                    VLOG(1) << "Skipping malformed version index line: " << e.what();
                 }
+            }
+        } else if (fs::exists(versionDir)) {
+            // Migrate a store of full copies written by older releases: each of them becomes a checkpoint
+            for (const auto& entry : fs::directory_iterator(versionDir)) {
+                const std::string extension = entry.path().extension().string();
+
+                if (entry.path().filename().string().starts_with(baseName + ".") && extension.size() > 1 &&
+                    std::all_of(extension.begin() + 1, extension.end(), [](char c) {
+                        return c >= '0' && c <= '9';
+                    })) {
+                    VersionEntry v;
+                    v.filename = entry.path().string();
+                    v.id = extension.substr(1);
 
-                // Fallback date if not in meta
-                if (v.date.empty()) {
                     try {
-                        long long ts = std::stoll(v.id);
-                        std::time_t t = static_cast<std::time_t>(ts);
-                        std::stringstream ss;
-                        ss << std::put_time(std::gmtime(&t), "%Y-%m-%dT%H:%M:%SZ");
-                        v.date = ss.str();
+                        nlohmann::json j = readJsonFile(v.filename);
+                        if (j.contains("meta")) {
+                            v.comment = j["meta"].value("comment", "");
+                            v.date = j["meta"].value("created", "");
+                        }
                     } catch (...) {
-                        v.date = "Unknown";
                     }
+
+                    index.push_back(v);
+                }
+            }
+
+            std::sort(index.begin(), index.end(), [](const VersionEntry& a, const VersionEntry& b) {
+                try {
+                    return std::stoll(a.id) < std::stoll(b.id);
+                } catch (...) {
+                    return a.id < b.id;
                 }
+            });
 
-                history.push_back(v);
+            if (!index.empty()) {
+                writeVersionIndex(mapFilePath, index);
             }
         }
-        // Sort by ID (descending)
-        std::sort(history.begin(), history.end(), [](const VersionEntry& a, const VersionEntry& b) {
-            // String comparison of timestamps works if they are same length, but better to be safe
+
+        return index;
+    }
+
+    void JsonMappingReader::writeVersionIndex(const std::string& mapFilePath, const std::vector<VersionEntry>& index) {
+        fs::path indexPath = getVersionDir(mapFilePath) / (fs::path(mapFilePath).filename().string() + ".index");
+        fs::path tmpPath = indexPath.string() + ".tmp";
+
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open version index for writing: " + tmpPath.string());
+        }
+        for (const VersionEntry& v : index) {
+            out << nlohmann::json({{"id", v.id}, {"date", v.date}, {"comment", v.comment}, {"checkpoint", v.checkpoint}}).dump() << '\n';
+        }
+        out.close();
+
+        fs::rename(tmpPath, indexPath);
+    }
+
+    nlohmann::json JsonMappingReader::reconstructVersion(const std::vector<VersionEntry>& index, std::size_t position) {
+        std::size_t checkpoint = position;
+        while (!index[checkpoint].checkpoint) {
+            if (checkpoint == 0) {
+                throw std::runtime_error("Version store corrupt: No checkpoint before version " + index[position].id);
+            }
+            --checkpoint;
+        }
+
+        nlohmann::json j = readJsonFile(index[checkpoint].filename);
+        for (std::size_t i = checkpoint + 1; i <= position; ++i) {
+            j = j.patch(readJsonFile(index[i].filename));
+        }
+
+        return j;
+    }
+
+    void JsonMappingReader::storeVersion(const std::string& mapFilePath, const std::string& id) {
+        fs::path versionDir = getVersionDir(mapFilePath);
+        if (!fs::exists(versionDir)) {
+            fs::create_directories(versionDir);
+        }
+        std::string baseName = fs::path(mapFilePath).filename().string();
+
+        std::vector<VersionEntry> index = readVersionIndex(mapFilePath);
+
+        // A second deploy within the same second replaces the version stored by the first one
+        if (!index.empty() && index.back().id == id) {
+            fs::remove(index.back().filename);
+            index.pop_back();
+        }
+
+        nlohmann::json current = readJsonFile(mapFilePath);
+
+        VersionEntry v;
+        v.id = id;
+        if (current.contains("meta")) {
+            v.comment = current["meta"].value("comment", "");
+            v.date = current["meta"].value("created", "");
+        }
+        if (v.date.empty()) {
+            v.date = formatTimestamp(id);
+        }
+
+        std::size_t sinceCheckpoint = 0;
+        while (sinceCheckpoint < index.size() && !index[index.size() - 1 - sinceCheckpoint].checkpoint) {
+            ++sinceCheckpoint;
+        }
+        v.checkpoint = index.empty() || sinceCheckpoint + 1 >= checkpointInterval;
+
+        if (!v.checkpoint) {
             try {
-                return std::stoll(a.id) > std::stoll(b.id);
-            } catch (...) {
-                return a.id > b.id;
+                nlohmann::json patch = nlohmann::json::diff(reconstructVersion(index, index.size() - 1), current);
+
+                v.filename = (versionDir / (baseName + "." + id + ".patch")).string();
+                std::ofstream out(v.filename, std::ios::trunc);
+                out << patch.dump();
+                out.close();
+                if (!out) {
+                    throw std::runtime_error("Cannot write version patch: " + v.filename);
+                }
+            } catch (const std::exception& e) {
+                VLOG(1) << "Storing version as patch failed, falling back to checkpoint: " << e.what();
+                if (!v.filename.empty()) {
+                    std::error_code errorCode;
+                    fs::remove(v.filename, errorCode);
+                }
+                v.checkpoint = true;
             }
-        });
+        }
+        if (v.checkpoint) {
+            v.filename = (versionDir / (baseName + "." + id)).string();
+            fs::copy_file(mapFilePath, v.filename, fs::copy_options::overwrite_existing);
+        }
+
+        index.push_back(v);
+
+        // Prune old versions (Keep at least the last maxVersions). Only whole checkpoint chains are dropped, as every patch needs its
+        // checkpoint
+        if (index.size() > maxVersions) {
+            std::size_t pruneCount = 0;
+            for (std::size_t i = 1; index.size() - i >= maxVersions; ++i) {
+                if (index[i].checkpoint) {
+                    pruneCount = i;
+                }
+            }
+            for (std::size_t i = 0; i < pruneCount; ++i) {
+                try {
+                    fs::remove(index[i].filename);
+                } catch (...) {
+                }
+            }
+            index.erase(index.begin(), index.begin() + static_cast<std::ptrdiff_t>(pruneCount));
+        }
+
+        writeVersionIndex(mapFilePath, index);
+    }
+
+    std::vector<JsonMappingReader::VersionEntry> JsonMappingReader::getHistory(const std::string& mapFilePath) {
+        std::vector<VersionEntry> history = readVersionIndex(mapFilePath);
+
+        for (VersionEntry& v : history) {
+            if (v.date.empty()) {
+                v.date = formatTimestamp(v.id);
+            }
+        }
+
+        // Index is oldest first, history is newest first
+        std::reverse(history.begin(), history.end());
+
         return history;
     }
 
     nlohmann::json JsonMappingReader::rollbackTo(const std::string& mapFilePath, const std::string& versionId) {
         nlohmann::json j;
 
-        fs::path versionDir = fs::path(mapFilePath).parent_path() / "versions";
-        std::string baseName = fs::path(mapFilePath).filename().string();
-        fs::path backupPath = versionDir / (baseName + "." + versionId);
+        std::vector<VersionEntry> index = readVersionIndex(mapFilePath);
 
-        if (!fs::exists(backupPath)) {
+        auto it = std::find_if(index.begin(), index.end(), [&versionId](const VersionEntry& v) {
+            return v.id == versionId;
+        });
+        if (it == index.end()) {
             throw std::runtime_error("Version not found: " + versionId);
         }
 
-        // Validate before rollback
+        // Reconstruct and validate before rollback
         try {
-            std::ifstream f(backupPath);
-            f >> j;
+            j = reconstructVersion(index, static_cast<std::size_t>(it - index.begin()));
             MqttMapper::validate(j);
         } catch (const std::exception& e) {
             throw std::runtime_error(std::string("Cannot rollback: Version is invalid against current schema: ") + e.what());
         }
 
         // Overwrite active file
-        fs::copy_file(backupPath, mapFilePath, fs::copy_options::overwrite_existing);
+        std::ofstream out(mapFilePath, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open mapping file for writing: " + mapFilePath);
+        }
+        out << j.dump(2);
+        out.close();
 
         // Delete any existing draft to avoid confusion
         discardDraft(mapFilePath);
@@ -46,6 +46,7 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <cstddef>
 #include <nlohmann/json_fwd.hpp> // IWYU pragma: export
 #include <string>
 #include <vector>
@@ -71,6 +72,7 @@ namespace mqtt::lib {
             std::string filename;
             std::string comment;
             std::string date;
+            bool checkpoint = true; // Full copy, otherwise an RFC 6902 patch against the previous version
         };
 
         static std::vector<VersionEntry> getHistory(const std::string& mapFilePath);
@@ -78,6 +80,16 @@ namespace mqtt::lib {
 
     private:
         static nlohmann::json getDefaultPatch(const nlohmann::json& inputJson);
+
+        // Version store: versions/<name>.index holds one JSON line of metadata per version (oldest first). Every
+        // checkpointInterval-th version is stored as full copy versions/<name>.<id>, all others as versions/<name>.<id>.patch
+        static std::vector<VersionEntry> readVersionIndex(const std::string& mapFilePath);
+        static void writeVersionIndex(const std::string& mapFilePath, const std::vector<VersionEntry>& index);
+        static nlohmann::json reconstructVersion(const std::vector<VersionEntry>& index, std::size_t position);
+        static void storeVersion(const std::string& mapFilePath, const std::string& id);
+
+        static constexpr std::size_t checkpointInterval = 10;
+        static constexpr std::size_t maxVersions = 50;
     };
 
 } // namespace mqtt::lib
@@ -43,6 +43,7 @@
 
 #include "ConfigApplication.h"
 #include "JsonMappingReader.h"
+#include "Metrics.h"
 #include "MqttMapper.h"
 
 #include <express/middleware/BasicAuthentication.h>
@@ -53,6 +54,7 @@
 
 #include "nlohmann/json-schema.hpp"
 
+#include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <fstream>
@@ -252,6 +254,25 @@ namespace mqtt::lib::admin {
             }
         });
 
+        // GET /config/cache
+        api.get("/config/cache", [configApplication] APPLICATION(req, res) {
+            const MqttMapper::RenderCacheStatistics statistics = configApplication->getMqttMapper()->getRenderCacheStatistics();
+            const uint64_t lookups = statistics.hits + statistics.misses;
+
+            res->status(200).json({{"capacity", statistics.capacity},
+                                   {"entries", statistics.entries},
+                                   {"hits", statistics.hits},
+                                   {"misses", statistics.misses},
+                                   {"bypasses", statistics.bypasses},
+                                   {"hit_rate", lookups > 0 ? static_cast<double>(statistics.hits) / static_cast<double>(lookups) : 0.0}});
+        });
+
+        // GET /metrics
+        api.get("/metrics", [] APPLICATION(req, res) {
+            res->set("Content-Type", metrics::Registry::contentType);
+            res->status(200).send(metrics::Registry::instance().renderPrometheus());
+        });
+
         api.get("/", [] APPLICATION(req, res) {
             res->redirect("/ui");
         });
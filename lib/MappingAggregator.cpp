@@ -0,0 +1,278 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "MappingAggregator.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib {
+
+    QuantileSketch::QuantileSketch()
+        : gamma((1 + relativeAccuracy) / (1 - relativeAccuracy))
+        , logGamma(std::log(gamma)) {
+    }
+
+    void QuantileSketch::add(double value) {
+        if (value > 1e-12) {
+            positiveBuckets[bucketIndex(value)]++;
+            collapse(positiveBuckets);
+        } else if (value < -1e-12) {
+            negativeBuckets[bucketIndex(-value)]++;
+            collapse(negativeBuckets);
+        } else {
+            zeroCount++;
+        }
+
+        count++;
+    }
+
+    void QuantileSketch::merge(const QuantileSketch& other) {
+        for (const auto& [index, bucketCount] : other.positiveBuckets) {
+            positiveBuckets[index] += bucketCount;
+        }
+        for (const auto& [index, bucketCount] : other.negativeBuckets) {
+            negativeBuckets[index] += bucketCount;
+        }
+
+        collapse(positiveBuckets);
+        collapse(negativeBuckets);
+
+        zeroCount += other.zeroCount;
+        count += other.count;
+    }
+
+    double QuantileSketch::quantile(double q) const {
+        double result = 0;
+
+        if (count > 0) {
+            const uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count - 1));
+            uint64_t seen = 0;
+            bool found = false;
+
+            for (auto bucketIt = negativeBuckets.rbegin(); !found && bucketIt != negativeBuckets.rend(); ++bucketIt) {
+                seen += bucketIt->second;
+                if (seen > rank) {
+                    result = -bucketValue(bucketIt->first);
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                seen += zeroCount;
+                found = seen > rank;
+            }
+
+            for (auto bucketIt = positiveBuckets.begin(); !found && bucketIt != positiveBuckets.end(); ++bucketIt) {
+                seen += bucketIt->second;
+                if (seen > rank) {
+                    result = bucketValue(bucketIt->first);
+                    found = true;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    uint64_t QuantileSketch::getCount() const {
+        return count;
+    }
+
+    int QuantileSketch::bucketIndex(double value) const {
+        return static_cast<int>(std::ceil(std::log(value) / logGamma));
+    }
+
+    double QuantileSketch::bucketValue(int index) const {
+        return 2 * std::pow(gamma, index) / (gamma + 1);
+    }
+
+    void QuantileSketch::collapse(std::map<int, uint64_t>& buckets) {
+        // Fold the buckets of the smallest magnitudes together. This only loses accuracy for the lowest quantiles of extremely wide
+        // value ranges
+        while (buckets.size() > maxBuckets) {
+            const auto smallest = buckets.begin();
+            std::next(smallest)->second += smallest->second;
+            buckets.erase(smallest);
+        }
+    }
+
+    MappingAggregator::Aggregation::Aggregation(const nlohmann::json& aggregateMapping) {
+        const nlohmann::json& window = aggregateMapping["window"];
+
+        const double size = window["size"];
+        advance = window.value("type", "tumbling") == "sliding" && window.contains("advance") ? window["advance"].get<double>() : size;
+        bucketCount = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(size / advance)));
+
+        for (const nlohmann::json& function : aggregateMapping.value("functions", nlohmann::json::array({"count", "min", "max", "avg"}))) {
+            const std::string functionName = function;
+
+            if (functionName.starts_with("p")) {
+                percentiles.emplace_back(functionName, std::stod(functionName.substr(1)) / 100);
+            } else {
+                functions.push_back(functionName);
+            }
+        }
+    }
+
+    void MappingAggregator::addValue(const nlohmann::json& aggregateMapping, const std::string& topic, double value, double now) {
+        Aggregation& aggregation = aggregations.try_emplace(&aggregateMapping, aggregateMapping).first->second;
+
+        const int64_t index = static_cast<int64_t>(std::floor(now / aggregation.advance));
+
+        Window& window = aggregation.windows[topic];
+        if (window.buckets.empty()) {
+            window.lastFlushedIndex = index - 1;
+        }
+        if (window.buckets.empty() || window.buckets.back().index < index) {
+            window.buckets.emplace_back();
+            window.buckets.back().index = index;
+        }
+
+        Bucket& bucket = window.buckets.back();
+        if (bucket.count == 0) {
+            bucket.min = value;
+            bucket.max = value;
+        } else {
+            bucket.min = std::min(bucket.min, value);
+            bucket.max = std::max(bucket.max, value);
+        }
+        bucket.sum += value;
+        bucket.last = value;
+        bucket.count++;
+
+        if (!aggregation.percentiles.empty()) {
+            bucket.sketch.add(value);
+        }
+    }
+
+    std::vector<MappingAggregator::Aggregate> MappingAggregator::flush(double now) {
+        std::vector<Aggregate> aggregates;
+
+        for (auto aggregationIt = aggregations.begin(); aggregationIt != aggregations.end();) {
+            Aggregation& aggregation = aggregationIt->second;
+
+            const int64_t completedIndex = static_cast<int64_t>(std::floor(now / aggregation.advance)) - 1;
+            const int64_t firstIndex = completedIndex - aggregation.bucketCount + 1;
+
+            for (auto windowIt = aggregation.windows.begin(); windowIt != aggregation.windows.end();) {
+                Window& window = windowIt->second;
+
+                if (window.lastFlushedIndex < completedIndex) {
+                    Bucket merged;
+                    for (const Bucket& bucket : window.buckets) {
+                        if (bucket.index >= firstIndex && bucket.index <= completedIndex && bucket.count > 0) {
+                            merged.min = merged.count == 0 ? bucket.min : std::min(merged.min, bucket.min);
+                            merged.max = merged.count == 0 ? bucket.max : std::max(merged.max, bucket.max);
+                            merged.sum += bucket.sum;
+                            merged.last = bucket.last;
+                            merged.count += bucket.count;
+                            merged.sketch.merge(bucket.sketch);
+                        }
+                    }
+
+                    if (merged.count > 0) {
+                        nlohmann::json values{{"start", static_cast<double>(firstIndex) * aggregation.advance},
+                                              {"end", static_cast<double>(completedIndex + 1) * aggregation.advance}};
+
+                        for (const std::string& function : aggregation.functions) {
+                            if (function == "min") {
+                                values["min"] = merged.min;
+                            } else if (function == "max") {
+                                values["max"] = merged.max;
+                            } else if (function == "sum") {
+                                values["sum"] = merged.sum;
+                            } else if (function == "count") {
+                                values["count"] = merged.count;
+                            } else if (function == "avg") {
+                                values["avg"] = merged.sum / static_cast<double>(merged.count);
+                            } else if (function == "last") {
+                                values["last"] = merged.last;
+                            }
+                        }
+                        for (const auto& [name, q] : aggregation.percentiles) {
+                            values[name] = merged.sketch.quantile(q);
+                        }
+
+                        aggregates.push_back({aggregationIt->first, windowIt->first, std::move(values)});
+                    }
+
+                    window.lastFlushedIndex = completedIndex;
+
+                    // Buckets not covered by the next window are not needed anymore
+                    while (!window.buckets.empty() && window.buckets.front().index <= firstIndex) {
+                        window.buckets.pop_front();
+                    }
+                }
+
+                if (window.buckets.empty()) {
+                    windowIt = aggregation.windows.erase(windowIt);
+                } else {
+                    ++windowIt;
+                }
+            }
+
+            if (aggregation.windows.empty()) {
+                aggregationIt = aggregations.erase(aggregationIt);
+            } else {
+                ++aggregationIt;
+            }
+        }
+
+        return aggregates;
+    }
+
+    void MappingAggregator::clear() {
+        aggregations.clear();
+    }
+
+    bool MappingAggregator::empty() const {
+        return aggregations.empty();
+    }
+
+} // namespace mqtt::lib
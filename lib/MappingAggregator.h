@@ -0,0 +1,140 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTT_LIB_MAPPINGAGGREGATOR_H
+#define MQTT_LIB_MAPPINGAGGREGATOR_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <nlohmann/json.hpp> // IWYU pragma: export
+#include <string>
+#include <vector>
+
+// IWYU pragma: no_include <nlohmann/json_fwd.hpp>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib {
+
+    // Mergeable quantile sketch with a bounded relative error. Values are counted in logarithmically sized buckets, so memory depends on
+    // the dynamic range of the values but not on their number.
+    class QuantileSketch {
+    public:
+        QuantileSketch();
+
+        void add(double value);
+        void merge(const QuantileSketch& other);
+
+        double quantile(double q) const;
+        uint64_t getCount() const;
+
+    private:
+        int bucketIndex(double value) const;
+        double bucketValue(int index) const;
+        static void collapse(std::map<int, uint64_t>& buckets);
+
+        static constexpr double relativeAccuracy = 0.01;
+        static constexpr std::size_t maxBuckets = 2048;
+
+        double gamma;
+        double logGamma;
+
+        std::map<int, uint64_t> positiveBuckets;
+        std::map<int, uint64_t> negativeBuckets;
+        uint64_t zeroCount = 0;
+        uint64_t count = 0;
+    };
+
+    // Tumbling and sliding window aggregation of numeric values, keyed by aggregate mapping and source topic. A sliding window of size
+    // 'size' advancing by 'advance' seconds is kept as size/advance consecutive buckets; a tumbling window is a sliding window with
+    // advance == size. Bucket boundaries are aligned to the epoch.
+    class MappingAggregator {
+    public:
+        struct Aggregate {
+            const nlohmann::json* aggregateMapping;
+            std::string topic;
+            nlohmann::json values;
+        };
+
+        void addValue(const nlohmann::json& aggregateMapping, const std::string& topic, double value, double now);
+        std::vector<Aggregate> flush(double now);
+
+        void clear();
+        bool empty() const;
+
+    private:
+        struct Bucket {
+            int64_t index = 0;
+            uint64_t count = 0;
+            double min = 0;
+            double max = 0;
+            double sum = 0;
+            double last = 0;
+            QuantileSketch sketch;
+        };
+
+        struct Window {
+            std::deque<Bucket> buckets;
+            int64_t lastFlushedIndex = -1;
+        };
+
+        struct Aggregation {
+            explicit Aggregation(const nlohmann::json& aggregateMapping);
+
+            double advance;
+            int64_t bucketCount;
+            std::vector<std::string> functions;
+            std::vector<std::pair<std::string, double>> percentiles;
+
+            std::map<std::string, Window> windows;
+        };
+
+        std::map<const nlohmann::json*, Aggregation> aggregations;
+    };
+
+} // namespace mqtt::lib
+
+#endif // MQTT_LIB_MAPPINGAGGREGATOR_H
@@ -0,0 +1,199 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Metrics.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <bit>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib::metrics {
+
+    static std::string formatDouble(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+        return buffer;
+    }
+
+    Metric::Metric(const std::string& name, const std::string& help)
+        : name(name)
+        , help(help) {
+    }
+
+    Metric::~Metric() = default;
+
+    void Metric::renderHeader(std::string& out, const char* type) const {
+        out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+    }
+
+    void Counter::render(std::string& out) const {
+        renderHeader(out, "counter");
+        out += name + " " + std::to_string(get()) + "\n";
+    }
+
+    void Gauge::render(std::string& out) const {
+        renderHeader(out, "gauge");
+        out += name + " " + std::to_string(get()) + "\n";
+    }
+
+    Histogram::Histogram(const std::string& name, const std::string& help, double scale)
+        : Metric(name, help)
+        , scale(scale) {
+    }
+
+    std::size_t Histogram::bucketIndex(std::uint64_t sample) {
+        std::size_t index = static_cast<std::size_t>(sample);
+
+        if (sample >= subBuckets) {
+            const unsigned exponent = static_cast<unsigned>(std::bit_width(sample)) - 1;
+            const std::size_t subBucket = static_cast<std::size_t>((sample >> (exponent - subBucketBits)) & (subBuckets - 1));
+
+            index = (exponent - subBucketBits + 1) * subBuckets + subBucket;
+        }
+
+        return index;
+    }
+
+    std::uint64_t Histogram::bucketUpperBound(std::size_t index) {
+        std::uint64_t upperBound = index;
+
+        if (index >= subBuckets) {
+            const unsigned shift = static_cast<unsigned>(index / subBuckets) - 1;
+            const std::uint64_t subBucket = index % subBuckets;
+
+            // Computed as (lower bound - 1) + width to avoid overflowing in the topmost bucket
+            upperBound = ((subBuckets + subBucket) << shift) - 1 + (std::uint64_t{1} << shift);
+        }
+
+        return upperBound;
+    }
+
+    void Histogram::observe(std::uint64_t sample) {
+        buckets[bucketIndex(sample)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(sample, std::memory_order_relaxed);
+    }
+
+    void Histogram::render(std::string& out) const {
+        renderHeader(out, "histogram");
+
+        // Empty buckets are skipped; the cumulative counts stay monotonic, which is all Prometheus needs
+        std::uint64_t cumulative = 0;
+        for (std::size_t index = 0; index < bucketCount; ++index) {
+            const std::uint64_t bucket = buckets[index].load(std::memory_order_relaxed);
+
+            if (bucket > 0) {
+                cumulative += bucket;
+                out += name + "_bucket{le=\"" + formatDouble(static_cast<double>(bucketUpperBound(index)) * scale) + "\"} " +
+                       std::to_string(cumulative) + "\n";
+            }
+        }
+
+        out += name + "_bucket{le=\"+Inf\"} " + std::to_string(count.load(std::memory_order_relaxed)) + "\n";
+        out += name + "_sum " + formatDouble(static_cast<double>(sum.load(std::memory_order_relaxed)) * scale) + "\n";
+        out += name + "_count " + std::to_string(count.load(std::memory_order_relaxed)) + "\n";
+    }
+
+    ScopedDuration::ScopedDuration(Histogram& histogram)
+        : histogram(histogram)
+        , start(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedDuration::~ScopedDuration() {
+        histogram.observe(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+    }
+
+    Registry& Registry::instance() {
+        static Registry registry;
+
+        return registry;
+    }
+
+    template <typename MetricType, typename... Args>
+    MetricType& Registry::getOrCreate(const std::string& name, Args&&... args) {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        std::unique_ptr<Metric>& metric = metrics[name];
+        if (!metric) {
+            metric = std::make_unique<MetricType>(name, std::forward<Args>(args)...);
+        }
+
+        MetricType* typedMetric = dynamic_cast<MetricType*>(metric.get());
+        if (typedMetric == nullptr) {
+            throw std::logic_error("Metric '" + name + "' already registered with a different type");
+        }
+
+        return *typedMetric;
+    }
+
+    Counter& Registry::counter(const std::string& name, const std::string& help) {
+        return getOrCreate<Counter>(name, help);
+    }
+
+    Gauge& Registry::gauge(const std::string& name, const std::string& help) {
+        return getOrCreate<Gauge>(name, help);
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const std::string& help, double scale) {
+        return getOrCreate<Histogram>(name, help, scale);
+    }
+
+    std::string Registry::renderPrometheus() const {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        std::string out;
+        for (const auto& [name, metric] : metrics) {
+            metric->render(out);
+        }
+
+        return out;
+    }
+
+} // namespace mqtt::lib::metrics
@@ -0,0 +1,187 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTT_LIB_METRICS_H
+#define MQTT_LIB_METRICS_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::lib::metrics {
+
+    // Process wide metrics in Prometheus text exposition format. Updating a metric is a single relaxed atomic operation, all formatting
+    // happens in Registry::renderPrometheus(), i.e. only when somebody scrapes.
+
+    class Metric {
+    public:
+        Metric(const std::string& name, const std::string& help);
+        virtual ~Metric();
+
+        Metric(const Metric&) = delete;
+        Metric& operator=(const Metric&) = delete;
+
+        virtual void render(std::string& out) const = 0;
+
+    protected:
+        void renderHeader(std::string& out, const char* type) const;
+
+        std::string name;
+        std::string help;
+    };
+
+    class Counter : public Metric {
+    public:
+        using Metric::Metric;
+
+        void inc(std::uint64_t n = 1) {
+            value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        std::uint64_t get() const {
+            return value.load(std::memory_order_relaxed);
+        }
+
+        void render(std::string& out) const override;
+
+    private:
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    class Gauge : public Metric {
+    public:
+        using Metric::Metric;
+
+        void set(std::int64_t n) {
+            value.store(n, std::memory_order_relaxed);
+        }
+
+        void add(std::int64_t n) {
+            value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        std::int64_t get() const {
+            return value.load(std::memory_order_relaxed);
+        }
+
+        void render(std::string& out) const override;
+
+    private:
+        std::atomic<std::int64_t> value{0};
+    };
+
+    // Log-linear histogram over unsigned integer samples: each power of two is split into 2^subBucketBits linear buckets, giving a relative
+    // error below 12.5% over the full 64 bit range. Samples are rendered multiplied by scale, e.g. 1e-6 for samples in microseconds.
+    class Histogram : public Metric {
+    public:
+        Histogram(const std::string& name, const std::string& help, double scale);
+
+        void observe(std::uint64_t sample);
+
+        void render(std::string& out) const override;
+
+    private:
+        static constexpr unsigned subBucketBits = 3;
+        static constexpr std::size_t subBuckets = std::size_t{1} << subBucketBits;
+        static constexpr std::size_t bucketCount = (64 - subBucketBits + 1) * subBuckets;
+
+        static std::size_t bucketIndex(std::uint64_t sample);
+        static std::uint64_t bucketUpperBound(std::size_t index); // Inclusive
+
+        double scale;
+
+        std::array<std::atomic<std::uint64_t>, bucketCount> buckets{};
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> sum{0};
+    };
+
+    // Observes the lifetime of the object in microseconds
+    class ScopedDuration {
+    public:
+        explicit ScopedDuration(Histogram& histogram);
+        ~ScopedDuration();
+
+        ScopedDuration(const ScopedDuration&) = delete;
+        ScopedDuration& operator=(const ScopedDuration&) = delete;
+
+    private:
+        Histogram& histogram;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    class Registry {
+    private:
+        Registry() = default;
+
+    public:
+        static Registry& instance();
+
+        // Registering an existing name returns the existing metric. Returned references stay valid for the lifetime of the process.
+        Counter& counter(const std::string& name, const std::string& help);
+        Gauge& gauge(const std::string& name, const std::string& help);
+        Histogram& histogram(const std::string& name, const std::string& help, double scale = 1e-6);
+
+        std::string renderPrometheus() const;
+
+        static constexpr const char* contentType = "text/plain; version=0.0.4; charset=utf-8";
+
+    private:
+        template <typename MetricType, typename... Args>
+        MetricType& getOrCreate(const std::string& name, Args&&... args);
+
+        mutable std::mutex mutex; // Guards registration and rendering only
+        std::map<std::string, std::unique_ptr<Metric>> metrics;
+    };
+
+} // namespace mqtt::lib::metrics
+
+#endif // MQTT_LIB_METRICS_H
@@ -41,6 +41,7 @@
 
 #include "MqttMapper.h"
 
+#include "Metrics.h"
 #include "MqttMapperPlugin.h"
 
 #include <core/DynamicLoader.h>
@@ -79,6 +80,11 @@
 #endif
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
 #include <log/Logger.h>
 #include <map>
 #include <nlohmann/json.hpp>
@@ -93,15 +99,41 @@ namespace mqtt::lib {
 
 #include "mapping-schema.json.h" // definition of 'static const std::string mappingJsonSchemaString;'
 
-    const nlohmann::json_schema::json_validator
-        MqttMapper::validator(nlohmann::json::parse(mappingJsonSchemaString), nullptr, nlohmann::json_schema::default_string_format_check);
+    // The schema cannot relate two properties: A sliding window advancing by more than its size would leave gaps between windows
+    static void checkAggregationWindows(const nlohmann::json& json) { // can throw
+        if (json.is_object()) {
+            if (json.contains("window") && json["window"].is_object()) {
+                const nlohmann::json& window = json["window"];
+
+                if (window.value("type", "tumbling") == "sliding" && window.contains("advance") && window.contains("size") &&
+                    window["advance"].get<double>() > window["size"].get<double>()) {
+                    throw std::runtime_error("Sliding window advance " + window["advance"].dump() + " exceeds its size " +
+                                             window["size"].dump());
+                }
+            }
+
+            for (const auto& [key, value] : json.items()) {
+                checkAggregationWindows(value);
+            }
+        } else if (json.is_array()) {
+            for (const nlohmann::json& element : json) {
+                checkAggregationWindows(element);
+            }
+        }
+    }
 
     MqttMapper::MqttMapper()
         : injaEnvironment(new inja::Environment) {
-        setMapping({});
+        // The schema default is what validating and patching an empty mapping yields. Using it directly avoids building the validator
+        // in case the mapping is later restored from a compiled mapping cache
+        const nlohmann::json defaultMappingJson = nlohmann::json::parse(mappingJsonSchemaString)["default"];
+
+        setCompiledMapping(defaultMappingJson, defaultMappingJson);
     }
 
     MqttMapper::~MqttMapper() {
+        aggregationTimer.cancel();
+
         delete injaEnvironment;
 
         for (void* pluginHandle : pluginHandles) {
@@ -113,36 +145,56 @@ namespace mqtt::lib {
         return mappingJsonSchemaString;
     }
 
-    bool MqttMapper::setMapping(nlohmann::json mappingJson) { // can throw
-        delete injaEnvironment;
+    const nlohmann::json_schema::json_validator& MqttMapper::getValidator() {
+        static const nlohmann::json_schema::json_validator validator(
+            nlohmann::json::parse(mappingJsonSchemaString), nullptr, nlohmann::json_schema::default_string_format_check);
 
-        for (void* handle : pluginHandles) {
-            core::DynamicLoader::dlClose(handle);
-        }
-        pluginHandles.clear();
-
-        injaEnvironment = new inja::Environment;
+        return validator;
+    }
 
+    bool MqttMapper::setMapping(nlohmann::json mappingJson) { // can throw
         nlohmann::json defaultPatch;
         try {
-            defaultPatch = validator.validate(mappingJson);
+            defaultPatch = getValidator().validate(mappingJson);
+            checkAggregationWindows(mappingJson);
         } catch (const std::exception& e) {
             throw std::runtime_error("Validating JSON failed: Mapping JSON = " + mappingJson.dump(4) + "\n" + e.what());
         }
 
-        nlohmann::json oldMappingJson = this->mappingJson;
+        nlohmann::json patchedMappingJson;
         try {
-            this->mappingJson = mappingJson.patch(defaultPatch);
-            if (mappingJson.empty()) {
-                this->mappingJsonUnpatched = this->mappingJson;
-            } else {
-                this->mappingJsonUnpatched = mappingJson;
-            }
+            patchedMappingJson = mappingJson.patch(defaultPatch);
         } catch (const std::exception& e) {
             throw std::runtime_error("Patching JSON with default patch failed: Default patch = " + defaultPatch.dump(4) + "\n" + e.what());
         }
 
-        bool mustReconnect = this->mappingJson["connection"] != oldMappingJson["connection"];
+        return setCompiledMapping(patchedMappingJson, mappingJson.empty() ? patchedMappingJson : mappingJson);
+    }
+
+    bool MqttMapper::setCompiledMapping(nlohmann::json mappingJson, const nlohmann::json& mappingJsonUnpatched) { // can throw
+        delete injaEnvironment;
+
+        for (void* handle : pluginHandles) {
+            core::DynamicLoader::dlClose(handle);
+        }
+        pluginHandles.clear();
+
+        renderCacheList.clear();
+        renderCacheMap.clear();
+        cacheableTemplates.clear();
+        impureFunctions.clear();
+
+        // Open windows refer to nodes of the old mapping
+        aggregationTimer.cancel();
+        aggregationTimerRunning = false;
+        mappingAggregator.clear();
+
+        injaEnvironment = new inja::Environment;
+
+        const bool mustReconnect = mappingJson["connection"] != this->mappingJson["connection"];
+
+        this->mappingJson = mappingJson;
+        this->mappingJsonUnpatched = mappingJsonUnpatched;
 
         if (mappingJson["mapping"].contains("plugins")) {
             VLOG(1) << "Loading plugins ...";
@@ -156,12 +208,23 @@ namespace mqtt::lib {
 
                     VLOG(1) << "  Loading plugin: " << plugin << " ...";
 
+                    const std::vector<std::string>* loadedPureFunctions =
+                        static_cast<std::vector<std::string>*>(core::DynamicLoader::dlSym(handle, "pureFunctions"));
+
                     const std::vector<mqtt::lib::Function>* loadedFunctions =
                         static_cast<std::vector<mqtt::lib::Function>*>(core::DynamicLoader::dlSym(handle, "functions"));
                     if (loadedFunctions != nullptr) {
                         VLOG(1) << "  Registering inja 'none void callbacks'";
                         for (const mqtt::lib::Function& function : *loadedFunctions) {
-                            VLOG(1) << "    " << function.name;
+                            const bool pure = loadedPureFunctions != nullptr &&
+                                              std::find(loadedPureFunctions->begin(), loadedPureFunctions->end(), function.name) !=
+                                                  loadedPureFunctions->end();
+
+                            VLOG(1) << "    " << function.name << (pure ? "" : " (impure)");
+
+                            if (!pure) {
+                                impureFunctions.insert(function.name);
+                            }
 
                             if (function.numArgs >= 0) {
                                 injaEnvironment->add_callback(function.name, function.numArgs, function.function);
@@ -181,6 +244,8 @@ namespace mqtt::lib {
                         for (const mqtt::lib::VoidFunction& voidFunction : *loadedVoidFunctions) {
                             VLOG(1) << "    " << voidFunction.name;
 
+                            impureFunctions.insert(voidFunction.name);
+
                             if (voidFunction.numArgs >= 0) {
                                 injaEnvironment->add_void_callback(voidFunction.name, voidFunction.numArgs, voidFunction.function);
                             } else {
@@ -209,6 +274,10 @@ namespace mqtt::lib {
         return mappingJsonUnpatched;
     }
 
+    const nlohmann::json& MqttMapper::getCompiledMapping() const {
+        return mappingJson;
+    }
+
     std::string MqttMapper::getClientId() const {
         return mappingJson["connection"]["client_id"];
     }
@@ -237,13 +306,23 @@ namespace mqtt::lib {
         return topicList;
     }
 
+    static metrics::Counter& mappingEvaluations =
+        metrics::Registry::instance().counter("mqttsuite_mapping_evaluations_total", "Publishes evaluated against the mapping");
+    static metrics::Counter& mappingPublishes =
+        metrics::Registry::instance().counter("mqttsuite_mapping_publishes_total", "Publishes produced by the mapping");
+    static metrics::Histogram& mappingDuration =
+        metrics::Registry::instance().histogram("mqttsuite_mapping_duration_seconds", "Time spent evaluating the mapping for one publish");
+
     MqttMapper::MappedPublishes MqttMapper::getMappings(const iot::mqtt::packets::Publish& publish) {
+        const metrics::ScopedDuration scopedDuration(mappingDuration);
+        mappingEvaluations.inc();
+
         MappedPublishes mappedPublishes;
         if (mappingJson.contains("mapping") && !mappingJson["mapping"].empty()) {
-            nlohmann::json matchingTopicLevel = findMatchingTopicLevel(mappingJson["mapping"]["topic_level"], publish.getTopic());
+            const nlohmann::json* matchingTopicLevel = findMatchingTopicLevel(mappingJson["mapping"]["topic_level"], publish.getTopic());
 
-            if (!matchingTopicLevel.empty()) {
-                const nlohmann::json& subscription = matchingTopicLevel["subscription"];
+            if (matchingTopicLevel != nullptr && matchingTopicLevel->contains("subscription")) {
+                const nlohmann::json& subscription = (*matchingTopicLevel)["subscription"];
 
                 if (subscription.contains("static")) {
                     VLOG(1) << "Topic mapping found for:";
@@ -290,18 +369,77 @@ namespace mqtt::lib {
                                 << "     Byte position of error: " << e.byte;
                     }
                 }
+
+                if (subscription.contains("aggregate")) {
+                    VLOG(1) << "Topic mapping found for:";
+                    VLOG(1) << "  Type: aggregate";
+                    VLOG(1) << "  Topic: " << publish.getTopic();
+                    VLOG(1) << "  Message: " << publish.getMessage();
+                    VLOG(1) << "  QoS: " << static_cast<uint16_t>(publish.getQoS());
+                    VLOG(1) << "  Retain: " << publish.getRetain();
+
+                    getAggregateMappings(subscription["aggregate"], publish);
+                }
             }
         }
 
+        mappingPublishes.inc(std::get<0>(mappedPublishes).size() + std::get<1>(mappedPublishes).size());
+
         return mappedPublishes;
     }
 
+    void MqttMapper::setOnAggregate(const std::function<void(const iot::mqtt::packets::Publish&)>& onAggregate) {
+        this->onAggregate = onAggregate;
+    }
+
+    void MqttMapper::setRenderCacheCapacity(std::size_t capacity) {
+        renderCacheCapacity = capacity;
+
+        while (renderCacheList.size() > renderCacheCapacity) {
+            renderCacheMap.erase(renderCacheList.back().key);
+            renderCacheList.pop_back();
+        }
+    }
+
+    MqttMapper::RenderCacheStatistics MqttMapper::getRenderCacheStatistics() const {
+        RenderCacheStatistics statistics = renderCacheStatistics;
+
+        statistics.entries = renderCacheList.size();
+        statistics.capacity = renderCacheCapacity;
+
+        return statistics;
+    }
+
+    std::size_t MqttMapper::RenderCacheKeyHash::operator()(const RenderCacheKey& key) const {
+        std::size_t hash = std::hash<const nlohmann::json*>{}(key.templateMapping);
+
+        hash ^= key.topicHash + 0x9e3779b9U + (hash << 6) + (hash >> 2);
+        hash ^= key.payloadHash + 0x9e3779b9U + (hash << 6) + (hash >> 2);
+        hash ^= (static_cast<std::size_t>(key.qoS) << 1 | static_cast<std::size_t>(key.retain)) + 0x9e3779b9U + (hash << 6) +
+                (hash >> 2);
+
+        return hash;
+    }
+
     const nlohmann::json MqttMapper::validate(const nlohmann::json& json) {
-        return validator.validate(json);
+        const nlohmann::json defaultPatch = getValidator().validate(json);
+
+        checkAggregationWindows(json);
+
+        return defaultPatch;
     }
 
     const nlohmann::json MqttMapper::validate(const nlohmann::json& json, nlohmann::json_schema::basic_error_handler& err) {
-        return validator.validate(json, err);
+        const nlohmann::json defaultPatch = getValidator().validate(json, err);
+
+        // Also catches the type errors of a document the schema already rejected
+        try {
+            checkAggregationWindows(json);
+        } catch (const std::exception& e) {
+            err.error(nlohmann::json::json_pointer(), json, e.what());
+        }
+
+        return defaultPatch;
     }
 
     void MqttMapper::extractSubscription(const nlohmann::json& topicLevelJson,
@@ -335,8 +473,8 @@ namespace mqtt::lib {
         }
     }
 
-    nlohmann::json MqttMapper::findMatchingTopicLevel(const nlohmann::json& topicLevel, const std::string& topic) const {
-        nlohmann::json foundTopicLevel;
+    const nlohmann::json* MqttMapper::findMatchingTopicLevel(const nlohmann::json& topicLevel, const std::string& topic) const {
+        const nlohmann::json* foundTopicLevel = nullptr;
 
         if (topicLevel.is_object()) {
             const std::string::size_type slashPosition = topic.find('/');
@@ -344,7 +482,7 @@ namespace mqtt::lib {
 
             if (topicLevel["name"] == topicLevelName || topicLevel["name"] == "+" || topicLevel["name"] == "#") {
                 if (slashPosition == std::string::npos) {
-                    foundTopicLevel = topicLevel;
+                    foundTopicLevel = &topicLevel;
                 } else if (topicLevel.contains("topic_level")) {
                     foundTopicLevel = findMatchingTopicLevel(topicLevel["topic_level"], topic.substr(slashPosition + 1));
                 }
@@ -353,7 +491,7 @@ namespace mqtt::lib {
             for (const nlohmann::json& topicLevelEntry : topicLevel) {
                 foundTopicLevel = findMatchingTopicLevel(topicLevelEntry, topic);
 
-                if (!foundTopicLevel.empty()) {
+                if (foundTopicLevel != nullptr) {
                     break;
                 }
             }
@@ -362,11 +500,13 @@ namespace mqtt::lib {
         return foundTopicLevel;
     }
 
-    void
+    bool
     MqttMapper::getMappedTemplate(const nlohmann::json& templateMapping, nlohmann::json& json, MappedPublishes& mappedPublishes) const {
         const std::string& mappingTemplate = templateMapping["mapping_template"];
         const std::string& mappedTopic = templateMapping["mapped_topic"];
 
+        bool rendered = false;
+
         try {
             // Render topic
             const std::string renderedTopic = injaEnvironment->render(mappedTopic, json);
@@ -404,6 +544,8 @@ namespace mqtt::lib {
                     }
                     VLOG(1) << "  Send mapping: suppressed";
                 }
+
+                rendered = true;
             } catch (const inja::InjaError& e) {
                 VLOG(1) << "  Message template rendering failed: " << mappingTemplate << " : " << json.dump();
                 VLOG(1) << "    What: " << e.what();
@@ -416,12 +558,125 @@ namespace mqtt::lib {
             VLOG(1) << "    INJA: " << e.type << ": " << e.message;
             VLOG(1) << "    INJA (line:column):" << e.location.line << ":" << e.location.column;
         }
+
+        return rendered;
+    }
+
+    void MqttMapper::getCachedTemplate(const nlohmann::json& templateMapping,
+                                       nlohmann::json& json,
+                                       const iot::mqtt::packets::Publish& publish,
+                                       MappedPublishes& mappedPublishes) {
+        if (renderCacheCapacity == 0) {
+            getMappedTemplate(templateMapping, json, mappedPublishes);
+        } else if (!isCacheable(templateMapping)) {
+            renderCacheStatistics.bypasses++;
+
+            getMappedTemplate(templateMapping, json, mappedPublishes);
+        } else {
+            const RenderCacheKey key{&templateMapping,
+                                     std::hash<std::string>{}(publish.getTopic()),
+                                     std::hash<std::string>{}(publish.getMessage()),
+                                     publish.getQoS(),
+                                     publish.getRetain()};
+
+            auto renderCacheMapIt = renderCacheMap.find(key);
+            if (renderCacheMapIt != renderCacheMap.end() && renderCacheMapIt->second->topic == publish.getTopic() &&
+                renderCacheMapIt->second->payload == publish.getMessage()) {
+                renderCacheStatistics.hits++;
+
+                renderCacheList.splice(renderCacheList.begin(), renderCacheList, renderCacheMapIt->second);
+
+                const RenderCacheEntry& renderCacheEntry = renderCacheList.front();
+
+                VLOG(1) << "  Render cache hit: " << renderCacheEntry.mappedTopic.get<std::string>();
+
+                json["mapped_topic"] = renderCacheEntry.mappedTopic;
+
+                const auto& [immediatePublishes, scheduledPublishes] = renderCacheEntry.mappedPublishes;
+                std::get<0>(mappedPublishes)
+                    .insert(std::get<0>(mappedPublishes).end(), immediatePublishes.begin(), immediatePublishes.end());
+                std::get<1>(mappedPublishes)
+                    .insert(std::get<1>(mappedPublishes).end(), scheduledPublishes.begin(), scheduledPublishes.end());
+            } else {
+                renderCacheStatistics.misses++;
+
+                MappedPublishes renderedPublishes;
+                if (getMappedTemplate(templateMapping, json, renderedPublishes)) {
+                    if (renderCacheMapIt != renderCacheMap.end()) { // Hash collision: replace the colliding entry
+                        renderCacheList.erase(renderCacheMapIt->second);
+                        renderCacheMap.erase(renderCacheMapIt);
+                    }
+
+                    renderCacheList.push_front({key, publish.getTopic(), publish.getMessage(), json["mapped_topic"], renderedPublishes});
+                    renderCacheMap[key] = renderCacheList.begin();
+
+                    if (renderCacheList.size() > renderCacheCapacity) {
+                        renderCacheMap.erase(renderCacheList.back().key);
+                        renderCacheList.pop_back();
+                    }
+                }
+
+                auto& [immediatePublishes, scheduledPublishes] = renderedPublishes;
+                std::get<0>(mappedPublishes).insert(std::get<0>(mappedPublishes).end(),
+                                                    std::make_move_iterator(immediatePublishes.begin()),
+                                                    std::make_move_iterator(immediatePublishes.end()));
+                std::get<1>(mappedPublishes).insert(std::get<1>(mappedPublishes).end(),
+                                                    std::make_move_iterator(scheduledPublishes.begin()),
+                                                    std::make_move_iterator(scheduledPublishes.end()));
+            }
+        }
+    }
+
+    bool MqttMapper::isCacheable(const nlohmann::json& templateMapping) {
+        auto cacheableTemplatesIt = cacheableTemplates.find(&templateMapping);
+
+        if (cacheableTemplatesIt == cacheableTemplates.end()) {
+            const std::string& mappingTemplate = templateMapping["mapping_template"];
+            const std::string& mappedTopic = templateMapping["mapped_topic"];
+
+            // A template is not cacheable if it calls an impure plugin function, depends on the per packet identifier, or reads the
+            // mapped topic of a preceding template mapping
+            const auto callsFunction = [](const std::string& templateString, const std::string& functionName) -> bool {
+                bool calls = false;
+
+                for (std::string::size_type position = templateString.find(functionName); !calls && position != std::string::npos;
+                     position = templateString.find(functionName, position + 1)) {
+                    const bool startsIdentifier =
+                        position == 0 || (std::isalnum(static_cast<unsigned char>(templateString[position - 1])) == 0 &&
+                                          templateString[position - 1] != '_' && templateString[position - 1] != '.');
+
+                    std::string::size_type next = position + functionName.size();
+                    while (next < templateString.size() && std::isspace(static_cast<unsigned char>(templateString[next])) != 0) {
+                        next++;
+                    }
+
+                    calls = startsIdentifier && next < templateString.size() && templateString[next] == '(';
+                }
+
+                return calls;
+            };
+
+            bool cacheable = mappingTemplate.find("package_identifier") == std::string::npos &&
+                             mappedTopic.find("package_identifier") == std::string::npos &&
+                             mappedTopic.find("mapped_topic") == std::string::npos;
+
+            for (auto impureFunctionIt = impureFunctions.begin(); cacheable && impureFunctionIt != impureFunctions.end();
+                 ++impureFunctionIt) {
+                cacheable = !callsFunction(mappingTemplate, *impureFunctionIt) && !callsFunction(mappedTopic, *impureFunctionIt);
+            }
+
+            VLOG(1) << "  Template mapping " << (cacheable ? "is" : "is not") << " cacheable: " << mappedTopic;
+
+            cacheableTemplatesIt = cacheableTemplates.emplace(&templateMapping, cacheable).first;
+        }
+
+        return cacheableTemplatesIt->second;
     }
 
     void MqttMapper::getTemplateMappings(const nlohmann::json& templateMapping,
                                          nlohmann::json& json,
                                          const iot::mqtt::packets::Publish& publish,
-                                         MappedPublishes& mappedPublishes) const {
+                                         MappedPublishes& mappedPublishes) {
         json["topic"] = publish.getTopic();
         json["qos"] = publish.getQoS();
         json["retain"] = publish.getRetain();
@@ -431,10 +686,10 @@ namespace mqtt::lib {
             VLOG(1) << "  Render data: " << json.dump();
 
             if (templateMapping.is_object()) {
-                getMappedTemplate(templateMapping, json, mappedPublishes);
+                getCachedTemplate(templateMapping, json, publish, mappedPublishes);
             } else {
                 for (const nlohmann::json& concreteTemplateMapping : templateMapping) {
-                    getMappedTemplate(concreteTemplateMapping, json, mappedPublishes);
+                    getCachedTemplate(concreteTemplateMapping, json, publish, mappedPublishes);
                 }
             }
         } catch (const nlohmann::json::exception& e) {
@@ -442,6 +697,94 @@ namespace mqtt::lib {
         }
     }
 
+    void MqttMapper::getAggregateMappings(const nlohmann::json& aggregateMapping, const iot::mqtt::packets::Publish& publish) {
+        if (aggregateMapping.is_array()) {
+            for (const nlohmann::json& concreteAggregateMapping : aggregateMapping) {
+                getAggregateMappings(concreteAggregateMapping, publish);
+            }
+        } else {
+            const std::string& valuePointer = aggregateMapping["value"];
+            const std::string& message = publish.getMessage();
+
+            double value = 0;
+            bool valid = false;
+
+            if (valuePointer.empty()) {
+                char* end = nullptr;
+                value = std::strtod(message.c_str(), &end);
+                valid = end != message.c_str() && *end == '\0';
+            } else {
+                try {
+                    const nlohmann::json messageJson = nlohmann::json::parse(message);
+                    const nlohmann::json& valueJson = messageJson.at(nlohmann::json::json_pointer(valuePointer));
+
+                    if (valueJson.is_number()) {
+                        value = valueJson.get<double>();
+                        valid = true;
+                    }
+                } catch (const nlohmann::json::exception& e) {
+                    VLOG(1) << "  Extracting value '" << valuePointer << "' failed: " << e.what();
+                }
+            }
+
+            if (valid) {
+                VLOG(1) << "  Aggregate value: " << value;
+
+                const double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+                mappingAggregator.addValue(aggregateMapping, publish.getTopic(), value, now);
+
+                if (!aggregationTimerRunning) {
+                    aggregationTimer = core::timer::Timer::intervalTimer(
+                        [this]() {
+                            flushAggregations();
+                        },
+                        1);
+                    aggregationTimerRunning = true;
+                }
+            } else {
+                VLOG(1) << "  Message is not a number: " << message;
+            }
+        }
+    }
+
+    void MqttMapper::flushAggregations() {
+        const double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        for (const MappingAggregator::Aggregate& aggregate : mappingAggregator.flush(now)) {
+            const nlohmann::json& aggregateMapping = *aggregate.aggregateMapping;
+
+            const nlohmann::json json{{"topic", aggregate.topic}, {"aggregate", aggregate.values}};
+
+            try {
+                const std::string renderedTopic = injaEnvironment->render(aggregateMapping["mapped_topic"].get<std::string>(), json);
+                const std::string renderedMessage =
+                    aggregateMapping.contains("mapping_template")
+                        ? injaEnvironment->render(aggregateMapping["mapping_template"].get<std::string>(), json)
+                        : aggregate.values.dump();
+
+                VLOG(1) << "Aggregate window closed for: " << aggregate.topic;
+                VLOG(1) << "  Send mapping:";
+                VLOG(1) << "    Topic: " << renderedTopic;
+                VLOG(1) << "    Message: " << renderedMessage;
+
+                if (onAggregate) {
+                    onAggregate(iot::mqtt::packets::Publish(
+                        0, renderedTopic, renderedMessage, aggregateMapping["qos"], false, aggregateMapping["retain"]));
+                }
+            } catch (const inja::InjaError& e) {
+                VLOG(1) << "Aggregate template rendering failed: " << json.dump();
+                VLOG(1) << "    What: " << e.what();
+                VLOG(1) << "    INJA: " << e.type << ": " << e.message;
+                VLOG(1) << "    INJA (line:column):" << e.location.line << ":" << e.location.column;
+            }
+        }
+
+        if (mappingAggregator.empty()) {
+            aggregationTimer.cancel();
+            aggregationTimerRunning = false;
+        }
+    }
+
     void MqttMapper::getStaticMappings(const nlohmann::json& staticMapping,
                                        const iot::mqtt::packets::Publish& publish,
                                        MappedPublishes& mappedPublishes) {
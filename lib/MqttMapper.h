@@ -46,6 +46,9 @@ namespace iot::mqtt {
     class Topic;
 } // namespace iot::mqtt
 
+#include "MappingAggregator.h"
+
+#include <core/timer/Timer.h>
 #include <iot/mqtt/packets/Publish.h>
 #include <utils/Timeval.h>
 
@@ -55,11 +58,15 @@ namespace inja {
     class Environment;
 }
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <nlohmann/json.hpp> // IWYU pragma: export
+#include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace nlohmann::json_schema {
@@ -83,6 +90,14 @@ namespace mqtt::lib {
         using MappedPublishes = std::tuple<std::vector<iot::mqtt::packets::Publish>, std::vector<ScheduledPublish>>;
         using ConnectParameter = std::tuple<bool, std::string, std::string, uint8_t, bool, std::string, std::string>;
 
+        struct RenderCacheStatistics {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t bypasses = 0;
+            std::size_t entries = 0;
+            std::size_t capacity = 0;
+        };
+
         MqttMapper();
         MqttMapper(const MqttMapper&) = delete;
         MqttMapper& operator=(const MqttMapper&) = delete;
@@ -94,6 +109,10 @@ namespace mqtt::lib {
         bool setMapping(nlohmann::json mappingJson); // can throw
         const nlohmann::json& getMapping() const;
 
+        // Activates an already validated and default-patched mapping, e.g. restored from the CompiledMappingCache
+        bool setCompiledMapping(nlohmann::json mappingJson, const nlohmann::json& mappingJsonUnpatched); // can throw
+        const nlohmann::json& getCompiledMapping() const;
+
         std::string getClientId() const;
         uint16_t getKeepAlive() const;
         ConnectParameter getConnectPayload() const;
@@ -101,6 +120,11 @@ namespace mqtt::lib {
         std::list<iot::mqtt::Topic> extractSubscriptions() const;
         MappedPublishes getMappings(const iot::mqtt::packets::Publish& publish);
 
+        void setOnAggregate(const std::function<void(const iot::mqtt::packets::Publish&)>& onAggregate);
+
+        void setRenderCacheCapacity(std::size_t capacity);
+        RenderCacheStatistics getRenderCacheStatistics() const;
+
         static const nlohmann::json validate(const nlohmann::json& json);
         static const nlohmann::json validate(const nlohmann::json& json, nlohmann::json_schema::basic_error_handler& err);
 
@@ -110,13 +134,21 @@ namespace mqtt::lib {
         static void
         extractSubscriptions(const nlohmann::json& mappingJson, const std::string& topic, std::list<iot::mqtt::Topic>& topicList);
 
-        nlohmann::json findMatchingTopicLevel(const nlohmann::json& topicLevel, const std::string& topic) const;
+        const nlohmann::json* findMatchingTopicLevel(const nlohmann::json& topicLevel, const std::string& topic) const;
 
-        void getMappedTemplate(const nlohmann::json& templateMapping, nlohmann::json& json, MappedPublishes& mappedPublishes) const;
+        bool getMappedTemplate(const nlohmann::json& templateMapping, nlohmann::json& json, MappedPublishes& mappedPublishes) const;
+        void getCachedTemplate(const nlohmann::json& templateMapping,
+                               nlohmann::json& json,
+                               const iot::mqtt::packets::Publish& publish,
+                               MappedPublishes& mappedPublishes);
         void getTemplateMappings(const nlohmann::json& templateMapping,
                                  nlohmann::json& json,
                                  const iot::mqtt::packets::Publish& publish,
-                                 MappedPublishes& mappedPublishes) const;
+                                 MappedPublishes& mappedPublishes);
+        bool isCacheable(const nlohmann::json& templateMapping);
+        void getAggregateMappings(const nlohmann::json& aggregateMapping, const iot::mqtt::packets::Publish& publish);
+        void flushAggregations();
+
         static void getStaticMappings(const nlohmann::json& staticMapping,
                                       const iot::mqtt::packets::Publish& publish,
                                       MappedPublishes& mappedPublishes);
@@ -133,7 +165,43 @@ namespace mqtt::lib {
 
         inja::Environment* injaEnvironment; // We need it as pointer as it must be destroyed befor unloading the plugin libraries
 
-        static const nlohmann::json_schema::json_validator validator;
+        // LRU cache of rendered template mappings. Keyed by the address of the template mapping node inside mappingJson, which is
+        // stable until the next setMapping(), and the hashes of topic and payload of the incoming publish.
+        struct RenderCacheKey {
+            const nlohmann::json* templateMapping;
+            std::size_t topicHash;
+            std::size_t payloadHash;
+            uint8_t qoS;
+            bool retain;
+
+            bool operator==(const RenderCacheKey& other) const = default;
+        };
+
+        struct RenderCacheKeyHash {
+            std::size_t operator()(const RenderCacheKey& key) const;
+        };
+
+        struct RenderCacheEntry {
+            RenderCacheKey key;
+            std::string topic; // Topic and payload are kept to rule out hash collisions
+            std::string payload;
+            nlohmann::json mappedTopic;
+            MappedPublishes mappedPublishes;
+        };
+
+        std::size_t renderCacheCapacity = 0;
+        std::list<RenderCacheEntry> renderCacheList; // Most recently used first
+        std::unordered_map<RenderCacheKey, std::list<RenderCacheEntry>::iterator, RenderCacheKeyHash> renderCacheMap;
+        std::unordered_map<const nlohmann::json*, bool> cacheableTemplates;
+        std::set<std::string> impureFunctions;
+        RenderCacheStatistics renderCacheStatistics;
+
+        MappingAggregator mappingAggregator;
+        core::timer::Timer aggregationTimer; // Shared by all aggregate mappings. Only running while windows are open
+        bool aggregationTimerRunning = false;
+        std::function<void(const iot::mqtt::packets::Publish&)> onAggregate;
+
+        static const nlohmann::json_schema::json_validator& getValidator(); // Built on first use only
 
         static const std::string mappingJsonSchemaString;
     };
@@ -49,6 +49,7 @@
 #include <algorithm>
 #include <functional>
 #include <nlohmann/json_fwd.hpp> // IWYU pragma: export
+#include <string>
 #include <vector>
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -92,4 +93,8 @@ namespace mqtt::lib {
 extern "C" std::vector<mqtt::lib::Function> functions;
 extern "C" std::vector<mqtt::lib::VoidFunction> voidFunctions;
 
+// Optional: names of functions whose result depends on their arguments only. Templates calling any other plugin function
+// bypass the render cache. Kept apart from Function so that plugins built against older headers stay binary compatible.
+extern "C" std::vector<std::string> pureFunctions;
+
 #endif // MQTT_LIB_MQTTMAPPERPLUGIN_H
@@ -87,4 +87,5 @@ namespace mqtt::lib::plugins::double_plugin {
 
 extern "C" {
     std::vector<mqtt::lib::Function> functions{{"double", 1, mqtt::lib::plugins::double_plugin::myDouble}};
+    std::vector<std::string> pureFunctions{"double"};
 }
@@ -41,6 +41,7 @@
 
 #include "lib/Bridge.h"
 
+#include "lib/Metrics.h"
 #include "lib/Mqtt.h"
 #include "lib/SSEDistributor.h"
 
@@ -50,27 +51,100 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <algorithm>
 #include <compare>
+#include <log/Logger.h>
 #include <map>
+#include <memory>
 #include <utility>
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
 namespace mqtt::bridge::lib {
 
-    Bridge::Bridge(const std::string& name, const std::string& prefix, bool disabled)
+    Bridge::Bridge(const std::string& name, const std::string& prefix, bool disabled, double dedupWindow, std::size_t dedupCapacity)
         : name(name)
         , prefix(prefix)
-        , disabled(disabled) {
+        , disabled(disabled)
+        , dedupCache(dedupWindow > 0 ? std::make_unique<DedupCache>(dedupWindow, dedupCapacity) : nullptr) {
+    }
+
+    void Bridge::clear() {
+        for (core::timer::Timer& flushTimer : flushTimers) {
+            flushTimer.cancel();
+        }
+        reportTimer.cancel();
+
+        brokerMap.clear();
+        routeTable.clear();
+        destinations.clear();
+        brokerPrefixes.clear();
+        topicPrefixes.clear();
+        sendQueues.clear();
+        spools.clear();
+        flushTimers.clear();
+        flushScheduled.clear();
+        reportedQueueDepths.clear();
+        reportedSpoolDepths.clear();
     }
 
     const std::string& Bridge::getName() const {
         return name;
     }
 
+    static SendQueue::Policy toPolicy(const std::string& policy) {
+        return policy == "drop_qos0" ? SendQueue::Policy::DropQoS0First
+               : policy == "spool"   ? SendQueue::Policy::Spool
+                                     : SendQueue::Policy::DropOldest;
+    }
+
     void Bridge::addBroker(const std::string& fullInstanceName, Broker&& broker) {
         enabledBroker += !broker.getDisabled() ? 1 : 0;
 
+        const std::size_t routeIndex = routeTable.addDestination(broker.getRouteIncludes(), broker.getRouteExcludes());
+        broker.setRouteIndex(routeIndex);
+        destinations.push_back(nullptr);
+
+        // The combined prefixes are fixed by the configuration, thus they are joined once instead of for every publish
+        brokerPrefixes.push_back(broker.getPrefix());
+        topicPrefixes.emplace_back();
+
+        for (std::size_t otherIndex = 0; otherIndex < routeIndex; otherIndex++) {
+            topicPrefixes[otherIndex].push_back(prefix + brokerPrefixes[otherIndex] + broker.getPrefix());
+        }
+        for (std::size_t otherIndex = 0; otherIndex <= routeIndex; otherIndex++) {
+            topicPrefixes[routeIndex].push_back(prefix + broker.getPrefix() + brokerPrefixes[otherIndex]);
+        }
+
+        // A disabled broker would only fill its spool
+        if (!broker.getDisabled() && !broker.getSpoolPath().empty()) {
+            spools.push_back(std::make_unique<Spool>(
+                broker.getSpoolPath(), broker.getSpoolMaxSize(), broker.getSpoolMaxAge(), broker.getSpoolSegmentSize()));
+        } else {
+            spools.push_back(nullptr);
+        }
+
+        SendQueue::Policy policy = toPolicy(broker.getQueuePolicy());
+        if (policy == SendQueue::Policy::Spool && spools.back() == nullptr) {
+            VLOG(0) << "Bridge: " << fullInstanceName << " has no spool configured, dropping the oldest queued messages instead";
+
+            policy = SendQueue::Policy::DropOldest;
+        }
+        sendQueues.emplace_back(broker.getQueueMaxMessages(), policy);
+
+        flushTimers.emplace_back();
+        flushScheduled.push_back(false);
+        reportedQueueDepths.push_back(0);
+        reportedSpoolDepths.push_back(0);
+
+        if (routeIndex == 0) {
+            reportTimer = core::timer::Timer::intervalTimer(
+                [this] {
+                    reportDestinations();
+                },
+                reportInterval);
+        }
+
         brokerMap.emplace(fullInstanceName, std::move(broker));
     }
 
@@ -84,6 +158,9 @@ namespace mqtt::bridge::lib {
 
     void Bridge::addMqtt(mqtt::bridge::lib::Mqtt* mqtt) {
         mqttList.push_back(mqtt);
+        destinations[mqtt->getBroker().getRouteIndex()] = mqtt;
+
+        scheduleFlush(mqtt->getBroker().getRouteIndex());
 
         mqtt::bridge::lib::SSEDistributor::instance().brokerConnected(name,
                                                                       mqtt->getMqttContext()->getSocketConnection()->getInstanceName());
@@ -94,7 +171,17 @@ namespace mqtt::bridge::lib {
     }
 
     void Bridge::removeMqtt(mqtt::bridge::lib::Mqtt* mqtt) {
+        const std::size_t routeIndex = mqtt->getBroker().getRouteIndex();
+
         mqttList.remove(mqtt);
+        destinations[routeIndex] = nullptr;
+
+        flushTimers[routeIndex].cancel();
+        flushScheduled[routeIndex] = false;
+
+        // Queued publishes are kept in the spool if there is one
+        spoolQueued(routeIndex);
+        sendQueues[routeIndex].clear();
 
         mqtt::bridge::lib::SSEDistributor::instance().brokerDisconnected(name,
                                                                          mqtt->getMqttContext()->getSocketConnection()->getInstanceName());
@@ -104,16 +191,180 @@ namespace mqtt::bridge::lib {
         }
     }
 
+    // Publishes are only queued while the spool is empty, and on overflow the queue moves into the spool before the overflowing
+    // publish. Thus the queue never holds publishes older than spooled ones and appending it keeps the order
+    void Bridge::spoolQueued(std::size_t routeIndex) {
+        SendQueue& sendQueue = sendQueues[routeIndex];
+
+        for (; spools[routeIndex] != nullptr && !sendQueue.empty(); sendQueue.pop()) {
+            const SendQueue::Publish& queued = sendQueue.front();
+
+            spools[routeIndex]->push(*queued.topic, *queued.message, queued.qoS, queued.retain);
+        }
+    }
+
+    static mqtt::lib::metrics::Counter& publishReceived = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_bridge_publish_received_total", "Publishes received from bridged brokers");
+    static mqtt::lib::metrics::Counter& publishForwarded = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_bridge_publish_forwarded_total", "Publishes forwarded to bridged brokers");
+    static mqtt::lib::metrics::Counter& publishQueued = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_bridge_publish_queued_total", "Publishes queued for bridged brokers not draining their socket");
+    static mqtt::lib::metrics::Counter& publishSpooled = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_bridge_publish_spooled_total", "Publishes spooled for disconnected or slow bridged brokers");
+    static mqtt::lib::metrics::Counter& publishDuplicates = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_bridge_publish_duplicates_total", "Publishes dropped as duplicates received over another path");
+    static mqtt::lib::metrics::Histogram& publishDuration = mqtt::lib::metrics::Registry::instance().histogram(
+        "mqttsuite_bridge_publish_duration_seconds", "Time spent forwarding a received publish to all destinations");
+
     void Bridge::publish(const mqtt::bridge::lib::Mqtt* originMqtt, const iot::mqtt::packets::Publish& publish) {
-        for (const mqtt::bridge::lib::Mqtt* destinationMqtt : mqttList) {
-            if (originMqtt != destinationMqtt) {    // Do not reflect message to origin broker. Avoid message looping
-                destinationMqtt->sendPublish(prefix //
-                                                 + originMqtt->getBroker().getPrefix()      //
-                                                 + destinationMqtt->getBroker().getPrefix() //
-                                                 + publish.getTopic(),
-                                             publish.getMessage(),
-                                             publish.getQoS(),
-                                             publish.getRetain());
+        const mqtt::lib::metrics::ScopedDuration scopedDuration(publishDuration);
+        publishReceived.inc();
+
+        // Publishes arriving over several paths of a meshed topology are forwarded once
+        if (dedupCache == nullptr || !dedupCache->isDuplicate(publish.getTopic(), publish.getMessage())) {
+            const std::size_t origin = originMqtt->getBroker().getRouteIndex();
+
+            // Copied once on the first destination queueing the publish and shared with the queues of the other destinations
+            std::shared_ptr<const std::string> queuedTopic; // Without topic prefix
+            std::shared_ptr<const std::string> queuedMessage;
+
+            for (const std::size_t destination : routeTable.match(publish.getTopic())) {
+                const mqtt::bridge::lib::Mqtt* destinationMqtt = destinations[destination];
+                Spool* spool = spools[destination].get();
+
+                // Do not reflect message to origin broker. Avoid message looping
+                if (destination != origin && (destinationMqtt != nullptr || spool != nullptr)) {
+                    const std::string& topicPrefix = topicPrefixes[origin][destination];
+
+                    if (!topicPrefix.empty()) {
+                        topic.clear();
+                        topic.reserve(topicPrefix.size() + publish.getTopic().size());
+                        topic.append(topicPrefix).append(publish.getTopic());
+                    }
+
+                    const std::string& destinationTopic = !topicPrefix.empty() ? topic : publish.getTopic();
+                    SendQueue& sendQueue = sendQueues[destination];
+
+                    // Publishes line up behind the queued and spooled ones to keep their order
+                    const bool forward = destinationMqtt != nullptr && sendQueue.empty() && (spool == nullptr || spool->empty()) &&
+                                         !isBacklogged(destinationMqtt);
+
+                    SendQueue::Result queueResult = SendQueue::Result::Rejected;
+                    if (!forward && destinationMqtt != nullptr && (spool == nullptr || spool->empty())) {
+                        if (queuedMessage == nullptr) {
+                            queuedMessage = std::make_shared<const std::string>(publish.getMessage());
+                        }
+                        if (queuedTopic == nullptr && topicPrefix.empty()) {
+                            queuedTopic = std::make_shared<const std::string>(publish.getTopic());
+                        }
+
+                        queueResult =
+                            sendQueue.push(topicPrefix.empty() ? queuedTopic : std::make_shared<const std::string>(destinationTopic),
+                                           queuedMessage,
+                                           publish.getQoS(),
+                                           publish.getRetain());
+
+                        if (queueResult == SendQueue::Result::Rejected) {
+                            spoolQueued(destination); // The overflowing publish is spooled behind the queued ones
+                        }
+                    }
+
+                    if (forward) {
+                        publishForwarded.inc();
+                        destinationMqtt->sendPublish(destinationTopic, publish.getMessage(), publish.getQoS(), publish.getRetain());
+                    } else if (queueResult == SendQueue::Result::Queued) {
+                        publishQueued.inc();
+                        scheduleFlush(destination);
+                    } else if (queueResult == SendQueue::Result::Rejected && spool != nullptr &&
+                               spool->push(destinationTopic, publish.getMessage(), publish.getQoS(), publish.getRetain())) {
+                        publishSpooled.inc();
+                        scheduleFlush(destination);
+                    }
+                }
+            }
+        } else {
+            publishDuplicates.inc();
+        }
+    }
+
+    bool Bridge::isBacklogged(const mqtt::bridge::lib::Mqtt* mqtt) {
+        const core::socket::stream::SocketConnection* socketConnection = mqtt->getMqttContext()->getSocketConnection();
+
+        return socketConnection->getTotalQueued() - socketConnection->getTotalSent() > mqtt->getBroker().getQueueMaxBacklog();
+    }
+
+    void Bridge::scheduleFlush(std::size_t routeIndex) {
+        if (!flushScheduled[routeIndex] && destinations[routeIndex] != nullptr &&
+            (!sendQueues[routeIndex].empty() || (spools[routeIndex] != nullptr && !spools[routeIndex]->empty()))) {
+            flushTimers[routeIndex] = core::timer::Timer::intervalTimer(
+                [this, routeIndex] {
+                    flush(routeIndex);
+                },
+                flushTick);
+            flushScheduled[routeIndex] = true;
+        }
+    }
+
+    void Bridge::flush(std::size_t routeIndex) {
+        const mqtt::bridge::lib::Mqtt* destinationMqtt = destinations[routeIndex];
+        SendQueue& sendQueue = sendQueues[routeIndex];
+        Spool* spool = spools[routeIndex].get();
+
+        while (!sendQueue.empty() && !isBacklogged(destinationMqtt)) {
+            const SendQueue::Publish& queued = sendQueue.front();
+
+            publishForwarded.inc();
+            destinationMqtt->sendPublish(*queued.topic, *queued.message, queued.qoS, queued.retain);
+
+            sendQueue.pop();
+        }
+
+        // The spool holds the newer publishes, it is drained at a limited rate once the queue is empty
+        if (sendQueue.empty() && spool != nullptr) {
+            const double drainRate = static_cast<double>(destinationMqtt->getBroker().getSpoolDrainRate());
+            uint64_t budget = std::max<uint64_t>(1, static_cast<uint64_t>(drainRate * flushTick));
+
+            Spool::Record record;
+            while (budget > 0 && !isBacklogged(destinationMqtt) && spool->front(record)) {
+                publishForwarded.inc();
+                destinationMqtt->sendPublish(std::string(record.topic), std::string(record.message), record.qoS, record.retain);
+
+                spool->pop();
+                budget--;
+            }
+        }
+
+        if (sendQueue.empty() && (spool == nullptr || spool->empty())) {
+            flushTimers[routeIndex].cancel();
+            flushScheduled[routeIndex] = false;
+        }
+    }
+
+    void Bridge::reportDestinations() {
+        if (dedupCache != nullptr && dedupCache->getHits() != reportedDedupHits) {
+            mqtt::bridge::lib::SSEDistributor::instance().bridgeDedup(name, dedupCache->getHits(), dedupCache->getSize());
+
+            reportedDedupHits = dedupCache->getHits();
+        }
+
+        for (const auto& [fullInstanceName, broker] : brokerMap) {
+            const std::size_t routeIndex = broker.getRouteIndex();
+
+            if (sendQueues[routeIndex].size() > 0 || reportedQueueDepths[routeIndex] > 0) {
+                mqtt::bridge::lib::SSEDistributor::instance().brokerQueue(
+                    name, fullInstanceName, sendQueues[routeIndex].size(), sendQueues[routeIndex].getDropped());
+
+                reportedQueueDepths[routeIndex] = sendQueues[routeIndex].size();
+            }
+
+            if (spools[routeIndex] != nullptr && (spools[routeIndex]->getDepth() > 0 || reportedSpoolDepths[routeIndex] > 0)) {
+                Spool& spool = *spools[routeIndex];
+                const double age = spool.getAge(); // Skips expired records first
+
+                mqtt::bridge::lib::SSEDistributor::instance().brokerSpool(
+                    name, fullInstanceName, spool.getDepth(), spool.getSize(), age, spool.getDropped(), spool.getExpired());
+
+                reportedSpoolDepths[routeIndex] = spool.getDepth();
             }
         }
     }
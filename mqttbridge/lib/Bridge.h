@@ -42,7 +42,13 @@
 #ifndef IOT_MQTTBROKER_MQTTBRIDGE_BRIDGE_H
 #define IOT_MQTTBROKER_MQTTBRIDGE_BRIDGE_H
 
-#include "lib/Broker.h" // IWYU pragma: export
+#include "lib/Broker.h"     // IWYU pragma: export
+#include "lib/DedupCache.h" // IWYU pragma: export
+#include "lib/RouteTable.h" // IWYU pragma: export
+#include "lib/SendQueue.h"  // IWYU pragma: export
+#include "lib/Spool.h"      // IWYU pragma: export
+
+#include <core/timer/Timer.h>
 
 namespace iot::mqtt {
     namespace packets {
@@ -58,8 +64,11 @@ namespace mqtt::bridge::lib {
 
 #include <cstddef>
 #include <list>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
@@ -67,11 +76,9 @@ namespace mqtt::bridge::lib {
 
     class Bridge {
     public:
-        explicit Bridge(const std::string& name, const std::string& prefix, bool disabled);
+        explicit Bridge(const std::string& name, const std::string& prefix, bool disabled, double dedupWindow, std::size_t dedupCapacity);
 
-        void clear() {
-            brokerMap.clear();
-        }
+        void clear();
 
         const std::string& getName() const;
 
@@ -95,6 +102,13 @@ namespace mqtt::bridge::lib {
         bool operator<(const Bridge& rhs) const;
 
     private:
+        static bool isBacklogged(const mqtt::bridge::lib::Mqtt* mqtt);
+
+        void spoolQueued(std::size_t routeIndex);
+        void scheduleFlush(std::size_t routeIndex);
+        void flush(std::size_t routeIndex);
+        void reportDestinations();
+
         std::string name;
         std::string prefix;
         bool disabled;
@@ -102,6 +116,27 @@ namespace mqtt::bridge::lib {
 
         std::map<const std::string, Broker> brokerMap;
         std::list<const mqtt::bridge::lib::Mqtt*> mqttList;
+
+        RouteTable routeTable;
+        std::vector<const mqtt::bridge::lib::Mqtt*> destinations; // Connected Mqtt by route index of its broker, nullptr if disconnected
+
+        std::vector<std::string> brokerPrefixes;             // By route index
+        std::vector<std::vector<std::string>> topicPrefixes; // Bridge, origin and destination prefix by origin and destination route index
+        std::string topic;                                   // Reused for building the outgoing topics
+
+        std::unique_ptr<DedupCache> dedupCache; // nullptr if disabled
+        uint64_t reportedDedupHits = 0;
+
+        std::vector<SendQueue> sendQueues;          // By route index
+        std::vector<std::unique_ptr<Spool>> spools; // By route index, nullptr if not configured
+        std::vector<core::timer::Timer> flushTimers;
+        std::vector<bool> flushScheduled;
+        std::vector<std::size_t> reportedQueueDepths;
+        std::vector<uint64_t> reportedSpoolDepths;
+        core::timer::Timer reportTimer;
+
+        static constexpr double flushTick = 0.01;
+        static constexpr double reportInterval = 5;
     };
 
 } // namespace mqtt::bridge::lib
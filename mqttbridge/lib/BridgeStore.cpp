@@ -179,7 +179,11 @@ namespace mqtt::bridge::lib {
 
         for (const nlohmann::json& bridgeConfigJson : bridgesConfigJsonActive["bridges"]) {
             bridgeMap.emplace(bridgeConfigJson["name"],
-                              Bridge{bridgeConfigJson["name"], bridgeConfigJson["prefix"], bridgeConfigJson["disabled"]});
+                              Bridge{bridgeConfigJson["name"],
+                                     bridgeConfigJson["prefix"],
+                                     bridgeConfigJson["disabled"],
+                                     bridgeConfigJson["dedup"]["window"],
+                                     bridgeConfigJson["dedup"]["capacity"]});
 
             for (const nlohmann::json& brokerConfigJson : bridgeConfigJson["brokers"]) {
                 std::list<iot::mqtt::Topic> topics;
@@ -190,6 +194,13 @@ namespace mqtt::bridge::lib {
                     }
                 }
 
+                const nlohmann::json& routes = brokerConfigJson["routes"];
+
+                const std::list<std::string> routeIncludes = routes["include"].get<std::list<std::string>>();
+                const std::list<std::string> routeExcludes = routes["exclude"].get<std::list<std::string>>();
+
+                const nlohmann::json& spool = brokerConfigJson["spool"];
+                const nlohmann::json& queue = brokerConfigJson["queue"];
                 const nlohmann::json& mqtt = brokerConfigJson["mqtt"];
                 const nlohmann::json& network = brokerConfigJson["network"];
 
@@ -217,7 +228,17 @@ namespace mqtt::bridge::lib {
                                               mqtt["loop_prevention"],
                                               brokerConfigJson["prefix"],
                                               brokerConfigJson["disabled"],
-                                              topics));
+                                              topics,
+                                              routeIncludes,
+                                              routeExcludes,
+                                              spool["path"],
+                                              spool["max_size"],
+                                              spool["max_age"],
+                                              spool["segment_size"],
+                                              spool["drain_rate"],
+                                              queue["max_messages"],
+                                              queue["max_backlog"],
+                                              queue["policy"]));
             }
         }
     }
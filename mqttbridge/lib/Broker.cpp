@@ -68,7 +68,17 @@ namespace mqtt::bridge::lib {
                    bool loopPrevention,
                    const std::string& prefix,
                    bool disabled,
-                   const std::list<iot::mqtt::Topic>& topics)
+                   const std::list<iot::mqtt::Topic>& topics,
+                   const std::list<std::string>& routeIncludes,
+                   const std::list<std::string>& routeExcludes,
+                   const std::string& spoolPath,
+                   uint64_t spoolMaxSize,
+                   uint64_t spoolMaxAge,
+                   uint64_t spoolSegmentSize,
+                   uint64_t spoolDrainRate,
+                   std::size_t queueMaxMessages,
+                   uint64_t queueMaxBacklog,
+                   const std::string& queuePolicy)
         : bridge(bridge)
         , sessionStoreFileName(sessionStoreFileName)
         , instanceName(std::move(instanceName))
@@ -88,7 +98,17 @@ namespace mqtt::bridge::lib {
         , loopPrevention(loopPrevention)
         , prefix(prefix)
         , disabled(disabled)
-        , topics(topics) {
+        , topics(topics)
+        , routeIncludes(routeIncludes)
+        , routeExcludes(routeExcludes)
+        , spoolPath(spoolPath)
+        , spoolMaxSize(spoolMaxSize)
+        , spoolMaxAge(spoolMaxAge)
+        , spoolSegmentSize(spoolSegmentSize)
+        , spoolDrainRate(spoolDrainRate)
+        , queueMaxMessages(queueMaxMessages)
+        , queueMaxBacklog(queueMaxBacklog)
+        , queuePolicy(queuePolicy) {
     }
 
     Bridge& Broker::getBridge() const {
@@ -171,4 +191,52 @@ namespace mqtt::bridge::lib {
         return address;
     }
 
+    const std::list<std::string>& Broker::getRouteIncludes() const {
+        return routeIncludes;
+    }
+
+    const std::list<std::string>& Broker::getRouteExcludes() const {
+        return routeExcludes;
+    }
+
+    void Broker::setRouteIndex(std::size_t routeIndex) {
+        this->routeIndex = routeIndex;
+    }
+
+    std::size_t Broker::getRouteIndex() const {
+        return routeIndex;
+    }
+
+    const std::string& Broker::getSpoolPath() const {
+        return spoolPath;
+    }
+
+    uint64_t Broker::getSpoolMaxSize() const {
+        return spoolMaxSize;
+    }
+
+    uint64_t Broker::getSpoolMaxAge() const {
+        return spoolMaxAge;
+    }
+
+    uint64_t Broker::getSpoolSegmentSize() const {
+        return spoolSegmentSize;
+    }
+
+    uint64_t Broker::getSpoolDrainRate() const {
+        return spoolDrainRate;
+    }
+
+    std::size_t Broker::getQueueMaxMessages() const {
+        return queueMaxMessages;
+    }
+
+    uint64_t Broker::getQueueMaxBacklog() const {
+        return queueMaxBacklog;
+    }
+
+    const std::string& Broker::getQueuePolicy() const {
+        return queuePolicy;
+    }
+
 } // namespace mqtt::bridge::lib
@@ -50,6 +50,7 @@ namespace mqtt::bridge::lib {
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <cstddef>
 #include <cstdint>
 #include <list>
 #include <nlohmann/json.hpp>
@@ -82,7 +83,17 @@ namespace mqtt::bridge::lib {
                bool loopPrevention,
                const std::string& prefix,
                bool disabled,
-               const std::list<iot::mqtt::Topic>& topics);
+               const std::list<iot::mqtt::Topic>& topics,
+               const std::list<std::string>& routeIncludes,
+               const std::list<std::string>& routeExcludes,
+               const std::string& spoolPath,
+               uint64_t spoolMaxSize,
+               uint64_t spoolMaxAge,
+               uint64_t spoolSegmentSize,
+               uint64_t spoolDrainRate,
+               std::size_t queueMaxMessages,
+               uint64_t queueMaxBacklog,
+               const std::string& queuePolicy);
 
         Broker(Broker&&) = default;
         Broker(const Broker&) = delete;
@@ -114,6 +125,22 @@ namespace mqtt::bridge::lib {
         const std::list<iot::mqtt::Topic>& getTopics() const;
         const nlohmann::json& getAddress() const;
 
+        const std::list<std::string>& getRouteIncludes() const;
+        const std::list<std::string>& getRouteExcludes() const;
+
+        void setRouteIndex(std::size_t routeIndex);
+        std::size_t getRouteIndex() const;
+
+        const std::string& getSpoolPath() const;
+        uint64_t getSpoolMaxSize() const;
+        uint64_t getSpoolMaxAge() const;
+        uint64_t getSpoolSegmentSize() const;
+        uint64_t getSpoolDrainRate() const;
+
+        std::size_t getQueueMaxMessages() const;
+        uint64_t getQueueMaxBacklog() const;
+        const std::string& getQueuePolicy() const;
+
     private:
         Bridge& bridge;
         std::string sessionStoreFileName;
@@ -139,6 +166,20 @@ namespace mqtt::bridge::lib {
         bool disabled;
 
         std::list<iot::mqtt::Topic> topics;
+
+        std::list<std::string> routeIncludes;
+        std::list<std::string> routeExcludes;
+        std::size_t routeIndex = 0;
+
+        std::string spoolPath;
+        uint64_t spoolMaxSize;
+        uint64_t spoolMaxAge;
+        uint64_t spoolSegmentSize;
+        uint64_t spoolDrainRate;
+
+        std::size_t queueMaxMessages;
+        uint64_t queueMaxBacklog;
+        std::string queuePolicy;
     };
 
 } // namespace mqtt::bridge::lib
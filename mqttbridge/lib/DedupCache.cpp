@@ -0,0 +1,93 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "DedupCache.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    DedupCache::DedupCache(double window, std::size_t capacity)
+        : window(window)
+        , generationCapacity(std::max<std::size_t>(1, capacity / 2))
+        , currentSince(std::chrono::steady_clock::now()) {
+        current.reserve(generationCapacity);
+        previous.reserve(generationCapacity);
+    }
+
+    bool DedupCache::isDuplicate(std::string_view topic, std::string_view message) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (now - currentSince > window || current.size() >= generationCapacity) {
+            std::swap(current, previous); // Keeps the buckets of both generations
+            current.clear();
+            currentSince = now;
+        }
+
+        uint64_t hash = std::hash<std::string_view>()(topic);
+        hash ^= std::hash<std::string_view>()(message) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+
+        const bool duplicate = current.contains(hash) || previous.contains(hash);
+
+        if (duplicate) {
+            hits++;
+        } else {
+            current.insert(hash);
+        }
+
+        return duplicate;
+    }
+
+    uint64_t DedupCache::getHits() const {
+        return hits;
+    }
+
+    std::size_t DedupCache::getSize() const {
+        return current.size() + previous.size();
+    }
+
+} // namespace mqtt::bridge::lib
@@ -0,0 +1,82 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MQTT_BRIDGE_LIB_DEDUPCACHE_H
+#define MQTT_BRIDGE_LIB_DEDUPCACHE_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_set>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    // Remembers the (topic, message) hashes of the publishes received by a bridge in two generations, each covering window seconds
+    // and at most half of capacity entries. A publish arriving again while its hash is remembered, at least for window seconds
+    // unless the capacity is exhausted earlier, is a duplicate.
+    class DedupCache {
+    public:
+        DedupCache(double window, std::size_t capacity);
+
+        bool isDuplicate(std::string_view topic, std::string_view message); // Remembers the publish if it is not
+
+        uint64_t getHits() const;
+        std::size_t getSize() const;
+
+    private:
+        std::chrono::duration<double> window;
+        std::size_t generationCapacity;
+
+        std::unordered_set<uint64_t> current;
+        std::unordered_set<uint64_t> previous;
+        std::chrono::steady_clock::time_point currentSince;
+
+        uint64_t hits = 0;
+    };
+
+} // namespace mqtt::bridge::lib
+
+#endif // MQTT_BRIDGE_LIB_DEDUPCACHE_H
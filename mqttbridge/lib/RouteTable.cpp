@@ -0,0 +1,183 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "RouteTable.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <log/Logger.h>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    std::size_t RouteTable::addDestination(const std::list<std::string>& includes, const std::list<std::string>& excludes) {
+        const std::size_t destination = destinationCount++;
+
+        if (includes.empty()) {
+            unfiltered.push_back(destination);
+        }
+
+        for (const std::string& include : includes) {
+            insert(include, destination, false);
+        }
+
+        for (const std::string& exclude : excludes) {
+            insert(exclude, destination, true);
+        }
+
+        marks.resize(destinationCount, 0);
+
+        return destination;
+    }
+
+    void RouteTable::clear() {
+        root = Node();
+        unfiltered.clear();
+        destinationCount = 0;
+
+        marks.clear();
+        touched.clear();
+        matched.clear();
+    }
+
+    const std::vector<std::size_t>& RouteTable::match(std::string_view topic) {
+        matched.clear();
+
+        mark(unfiltered, included);
+        match(root, topic, 0, topic.starts_with('$'));
+
+        for (const std::size_t destination : touched) {
+            if (marks[destination] == included) {
+                matched.push_back(destination);
+            }
+
+            marks[destination] = 0;
+        }
+
+        touched.clear();
+
+        return matched;
+    }
+
+    bool RouteTable::isValidFilter(std::string_view filter) {
+        bool valid = !filter.empty();
+
+        for (std::size_t position = 0; valid && position <= filter.size();) {
+            const std::size_t end = std::min(filter.find('/', position), filter.size());
+            const std::string_view level = filter.substr(position, end - position);
+
+            valid = (level == "#" && end == filter.size()) || level == "+" || level.find_first_of("#+") == std::string_view::npos;
+
+            position = end + 1;
+        }
+
+        return valid;
+    }
+
+    void RouteTable::insert(std::string_view filter, std::size_t destination, bool exclude) {
+        if (isValidFilter(filter)) {
+            Node* node = &root;
+
+            for (std::size_t position = 0; position <= filter.size();) {
+                const std::size_t end = std::min(filter.find('/', position), filter.size());
+                const std::string_view level = filter.substr(position, end - position);
+
+                if (level == "#") {
+                    (exclude ? node->multiLevelExcludes : node->multiLevelIncludes).push_back(destination);
+                    node = nullptr;
+                    break;
+                }
+
+                auto it = node->children.find(level);
+                if (it == node->children.end()) {
+                    it = node->children.emplace(level, Node()).first;
+                }
+                node = &it->second;
+
+                position = end + 1;
+            }
+
+            if (node != nullptr) {
+                (exclude ? node->excludes : node->includes).push_back(destination);
+            }
+        } else {
+            VLOG(1) << "  Route: Ignoring invalid topic filter '" << filter << "'";
+        }
+    }
+
+    void RouteTable::match(const Node& node, std::string_view topic, std::size_t position, bool systemTopic) {
+        // Wildcards on the first level do not match topics starting with '$'
+        const bool wildcards = !systemTopic || &node != &root;
+
+        if (wildcards) { // "a/#" matches "a" as well as everything below it
+            mark(node.multiLevelIncludes, included);
+            mark(node.multiLevelExcludes, excluded);
+        }
+
+        if (position > topic.size()) {
+            mark(node.includes, included);
+            mark(node.excludes, excluded);
+        } else {
+            const std::size_t end = std::min(topic.find('/', position), topic.size());
+
+            if (const auto it = node.children.find(topic.substr(position, end - position)); it != node.children.end()) {
+                match(it->second, topic, end + 1, systemTopic);
+            }
+
+            if (const auto it = node.children.find("+"); wildcards && it != node.children.end()) {
+                match(it->second, topic, end + 1, systemTopic);
+            }
+        }
+    }
+
+    void RouteTable::mark(const std::vector<std::size_t>& destinations, uint8_t flag) {
+        for (const std::size_t destination : destinations) {
+            if (marks[destination] == 0) {
+                touched.push_back(destination);
+            }
+
+            marks[destination] |= flag;
+        }
+    }
+
+} // namespace mqtt::bridge::lib
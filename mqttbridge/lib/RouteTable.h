@@ -0,0 +1,100 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MQTT_BRIDGE_LIB_ROUTETABLE_H
+#define MQTT_BRIDGE_LIB_ROUTETABLE_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    // Topic trie over the route filters of all destinations of a bridge. A destination is routed a topic if at least one of its
+    // include filters, or it has none, and none of its exclude filters match it.
+    class RouteTable {
+    public:
+        std::size_t addDestination(const std::list<std::string>& includes, const std::list<std::string>& excludes);
+        void clear();
+
+        // Destinations routed for the topic in one walk of the trie. Valid until the next call
+        const std::vector<std::size_t>& match(std::string_view topic);
+
+    private:
+        struct Node {
+            std::map<std::string, Node, std::less<>> children;
+
+            std::vector<std::size_t> includes; // Filters ending at this level
+            std::vector<std::size_t> excludes;
+            std::vector<std::size_t> multiLevelIncludes; // Filters ending with "#" below this level
+            std::vector<std::size_t> multiLevelExcludes;
+        };
+
+        static bool isValidFilter(std::string_view filter);
+
+        void insert(std::string_view filter, std::size_t destination, bool exclude);
+        void match(const Node& node, std::string_view topic, std::size_t position, bool systemTopic);
+        void mark(const std::vector<std::size_t>& destinations, uint8_t flag);
+
+        Node root;
+        std::vector<std::size_t> unfiltered; // Destinations without include filters
+        std::size_t destinationCount = 0;
+
+        static constexpr uint8_t included = 1;
+        static constexpr uint8_t excluded = 2;
+
+        std::vector<uint8_t> marks; // Per destination, reset after every match
+        std::vector<std::size_t> touched;
+        std::vector<std::size_t> matched;
+    };
+
+} // namespace mqtt::bridge::lib
+
+#endif // MQTT_BRIDGE_LIB_ROUTETABLE_H
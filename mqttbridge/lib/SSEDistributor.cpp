@@ -111,7 +111,7 @@ namespace mqtt::bridge::lib {
         sendEvent(response, json.dump(), event, id);
     }
 
-    void SSEDistributor::sendEvent(const std::string& data, const std::string& event, const std::string& id) {
+    void SSEDistributor::sendEvent(const std::string& data, const std::string& event, const std::string& id, bool replay) {
         VLOG(0) << "Server sent event: " << event << "\n" << data;
 
         for (const auto& eventReceiver : eventReceiverList) {
@@ -120,11 +120,13 @@ namespace mqtt::bridge::lib {
             }
         }
 
-        replayEvents.emplace_back(data, event, id);
+        if (replay) {
+            replayEvents.emplace_back(data, event, id);
+        }
     }
 
-    void SSEDistributor::sendJsonEvent(const nlohmann::json& json, const std::string& event, const std::string& id) {
-        sendEvent(json.dump(), event, id);
+    void SSEDistributor::sendJsonEvent(const nlohmann::json& json, const std::string& event, const std::string& id, bool replay) {
+        sendEvent(json.dump(), event, id, replay);
     }
 
     void SSEDistributor::bridgesStarting() {
@@ -170,6 +172,13 @@ namespace mqtt::bridge::lib {
             {{"at", timePointToString(std::chrono::system_clock::now())}, {"name", bridgeName}}, "bridge_stopped", std::to_string(id++));
     }
 
+    void SSEDistributor::bridgeDedup(const std::string& bridgeName, uint64_t hits, std::size_t size) {
+        sendJsonEvent({{"at", timePointToString(std::chrono::system_clock::now())}, {"name", bridgeName}, {"hits", hits}, {"size", size}},
+                      "bridge_dedup",
+                      std::to_string(id++),
+                      false);
+    }
+
     void SSEDistributor::brokerDisabled(const std::string& bridgeName, const std::string& instanceName) {
         sendJsonEvent({{"at", timePointToString(std::chrono::system_clock::now())}, {"bridge", bridgeName}, {"instance", instanceName}},
                       "broker_disabled",
@@ -200,6 +209,38 @@ namespace mqtt::bridge::lib {
                       std::to_string(id++));
     }
 
+    void SSEDistributor::brokerQueue(const std::string& bridgeName, const std::string& instanceName, std::size_t depth, uint64_t dropped) {
+        sendJsonEvent({{"at", timePointToString(std::chrono::system_clock::now())},
+                       {"bridge", bridgeName},
+                       {"instance", instanceName},
+                       {"depth", depth},
+                       {"dropped", dropped}},
+                      "broker_queue",
+                      std::to_string(id++),
+                      false);
+    }
+
+    void SSEDistributor::brokerSpool(const std::string& bridgeName,
+                                     const std::string& instanceName,
+                                     uint64_t depth,
+                                     uint64_t size,
+                                     double age,
+                                     uint64_t dropped,
+                                     uint64_t expired) {
+        // Periodic status of the queues and spools, not replayed to late receivers
+        sendJsonEvent({{"at", timePointToString(std::chrono::system_clock::now())},
+                       {"bridge", bridgeName},
+                       {"instance", instanceName},
+                       {"depth", depth},
+                       {"size", size},
+                       {"age", age},
+                       {"dropped", dropped},
+                       {"expired", expired}},
+                      "broker_spool",
+                      std::to_string(id++),
+                      false);
+    }
+
     std::string SSEDistributor::bridgesStartedAt() const {
         return timePointToString(bridgesStartTimePoint);
     }
@@ -50,6 +50,7 @@ namespace express {
 
 #include <chrono>
 #include <core/timer/Timer.h>
+#include <cstddef>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -129,6 +130,8 @@ namespace mqtt::bridge::lib {
         void bridgeStopping(const std::string& bridgeName);
         void bridgeStopped(const std::string& bridgeName);
 
+        void bridgeDedup(const std::string& bridgeName, uint64_t hits, std::size_t size);
+
         void brokerDisabled(const std::string& bridgeName, const std::string& instanceName);
         void brokerConnecting(const std::string& bridgeName, const std::string& instanceName);
         void brokerConnected(const std::string& bridgeName, const std::string& instanceName);
@@ -136,6 +139,15 @@ namespace mqtt::bridge::lib {
         void brokerDisconnecting(const std::string& bridgeName, const std::string& instanceName);
         void brokerDisconnected(const std::string& bridgeName, const std::string& instanceName);
 
+        void brokerQueue(const std::string& bridgeName, const std::string& instanceName, std::size_t depth, uint64_t dropped);
+        void brokerSpool(const std::string& bridgeName,
+                         const std::string& instanceName,
+                         uint64_t depth,
+                         uint64_t size,
+                         double age,
+                         uint64_t dropped,
+                         uint64_t expired);
+
     private:
         static void sendEvent(const std::shared_ptr<express::Response>& response,
                               const std::string& data,
@@ -146,8 +158,8 @@ namespace mqtt::bridge::lib {
                                    const nlohmann::json& json,
                                    const std::string& event = "",
                                    const std::string& id = "");
-        void sendEvent(const std::string& data, const std::string& event = "", const std::string& id = "");
-        void sendJsonEvent(const nlohmann::json& json, const std::string& event = "", const std::string& id = "");
+        void sendEvent(const std::string& data, const std::string& event = "", const std::string& id = "", bool replay = true);
+        void sendJsonEvent(const nlohmann::json& json, const std::string& event = "", const std::string& id = "", bool replay = true);
 
         static std::string timePointToString(const std::chrono::time_point<std::chrono::system_clock>& timePoint);
         static std::string
@@ -0,0 +1,114 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "SendQueue.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    SendQueue::SendQueue(std::size_t maxMessages, Policy policy)
+        : maxMessages(maxMessages)
+        , policy(policy) {
+    }
+
+    SendQueue::Result SendQueue::push(const std::shared_ptr<const std::string>& topic,
+                                      const std::shared_ptr<const std::string>& message,
+                                      uint8_t qoS,
+                                      bool retain) {
+        Result result = Result::Queued;
+
+        if (size() >= maxMessages) {
+            if (policy == Policy::Spool) {
+                result = Result::Rejected;
+            } else if (policy == Policy::DropQoS0First && !qoS0Publishes.empty()) {
+                qoS0Publishes.pop_front();
+                dropped++;
+            } else if (policy == Policy::DropQoS0First && qoS == 0) {
+                result = Result::Dropped; // The incoming publish is the oldest QoS 0 one
+                dropped++;
+            } else {
+                pop();
+                dropped++;
+            }
+        }
+
+        if (result == Result::Queued) {
+            (qoS == 0 ? qoS0Publishes : publishes).push_back({nextSequence++, {topic, message, qoS, retain}});
+        }
+
+        return result;
+    }
+
+    bool SendQueue::isQoS0Oldest() const {
+        return !qoS0Publishes.empty() && (publishes.empty() || qoS0Publishes.front().sequence < publishes.front().sequence);
+    }
+
+    const SendQueue::Publish& SendQueue::front() const {
+        return (isQoS0Oldest() ? qoS0Publishes : publishes).front().publish;
+    }
+
+    void SendQueue::pop() {
+        (isQoS0Oldest() ? qoS0Publishes : publishes).pop_front();
+    }
+
+    void SendQueue::clear() {
+        dropped += size();
+
+        qoS0Publishes.clear();
+        publishes.clear();
+    }
+
+    bool SendQueue::empty() const {
+        return qoS0Publishes.empty() && publishes.empty();
+    }
+
+    std::size_t SendQueue::size() const {
+        return qoS0Publishes.size() + publishes.size();
+    }
+
+    uint64_t SendQueue::getDropped() const {
+        return dropped;
+    }
+
+} // namespace mqtt::bridge::lib
@@ -0,0 +1,111 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MQTT_BRIDGE_LIB_SENDQUEUE_H
+#define MQTT_BRIDGE_LIB_SENDQUEUE_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    // Bounded queue of the publishes waiting for the socket of a bridge destination to drain. Topic and message are shared with the
+    // queues of the other destinations of the same publish. QoS 0 publishes are kept apart from the others, thus the oldest of them is
+    // dropped in constant time, and are merged back in arrival order on the way out
+    class SendQueue {
+    public:
+        enum class Policy { DropOldest, DropQoS0First, Spool };
+
+        enum class Result {
+            Queued,
+            Dropped, // The incoming QoS 0 publish itself has been dropped
+            Rejected // The queue is full and the publish is to be spooled by the caller
+        };
+
+        struct Publish {
+            std::shared_ptr<const std::string> topic;
+            std::shared_ptr<const std::string> message;
+            uint8_t qoS = 0;
+            bool retain = false;
+        };
+
+        SendQueue(std::size_t maxMessages, Policy policy);
+
+        Result push(const std::shared_ptr<const std::string>& topic,
+                    const std::shared_ptr<const std::string>& message,
+                    uint8_t qoS,
+                    bool retain);
+
+        const Publish& front() const;
+        void pop();
+        void clear();
+
+        bool empty() const;
+        std::size_t size() const;
+        uint64_t getDropped() const;
+
+    private:
+        struct Entry {
+            uint64_t sequence;
+            Publish publish;
+        };
+
+        bool isQoS0Oldest() const;
+
+        std::size_t maxMessages;
+        Policy policy;
+
+        std::deque<Entry> qoS0Publishes;
+        std::deque<Entry> publishes; // QoS 1 and 2
+        uint64_t nextSequence = 0;
+        uint64_t dropped = 0;
+    };
+
+} // namespace mqtt::bridge::lib
+
+#endif // MQTT_BRIDGE_LIB_SENDQUEUE_H
@@ -0,0 +1,371 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Spool.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <log/Logger.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    template <typename ValueType>
+    static ValueType load(const char* data) {
+        ValueType value;
+        std::memcpy(&value, data, sizeof(value));
+
+        return value;
+    }
+
+    template <typename ValueType>
+    static void store(char* data, ValueType value) {
+        std::memcpy(data, &value, sizeof(value));
+    }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    Spool::Spool(const std::string& directory, uint64_t maxSize, uint64_t maxAge, uint64_t segmentSize)
+        : directory(directory)
+        , maxSegments(std::max<uint64_t>(1, maxSize / segmentSize))
+        , maxAge(maxAge)
+        , segmentSize(segmentSize) {
+        std::error_code errorCode;
+        std::filesystem::create_directories(directory, errorCode);
+
+        if (!errorCode) {
+            std::vector<uint64_t> numbers;
+
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, errorCode)) {
+                if (entry.path().extension() == ".spool") {
+                    try {
+                        numbers.push_back(std::stoull(entry.path().stem().string(), nullptr, 16));
+                    } catch (const std::exception&) {
+                        // Not a segment of ours
+                    }
+                }
+            }
+
+            std::sort(numbers.begin(), numbers.end());
+
+            for (const uint64_t number : numbers) {
+                openSegment(number, false);
+            }
+
+            if (segments.empty()) {
+                openSegment(0, true);
+            }
+
+            VLOG(1) << "Spool: " << directory << " holds " << depth << " messages";
+        } else {
+            VLOG(0) << "Spool: Cannot create '" << directory << "': " << errorCode.message();
+        }
+    }
+
+    Spool::~Spool() {
+        for (Segment& segment : segments) {
+            closeSegment(segment, false);
+        }
+    }
+
+    bool Spool::isOpen() const {
+        return !segments.empty();
+    }
+
+    bool Spool::push(std::string_view topic, std::string_view message, uint8_t qoS, bool retain) {
+        const uint64_t recordSize = (spool::recordHeaderSize + topic.size() + message.size() + 7) & ~uint64_t{7};
+
+        // A record and the terminating zero size need to fit into a segment
+        bool success = isOpen() && recordSize + sizeof(uint32_t) <= segmentSize - spool::segmentHeaderSize;
+
+        if (success && segments.back().writeOffset + recordSize + sizeof(uint32_t) > segments.back().capacity) {
+            const uint64_t number = segments.back().number + 1;
+
+            while (segments.size() >= maxSegments) {
+                dropHead();
+            }
+
+            success = openSegment(number, true);
+        }
+
+        if (success) {
+            Segment& tail = segments.back();
+            char* record = tail.data + tail.writeOffset;
+
+            store<uint32_t>(record, static_cast<uint32_t>(recordSize));
+            store<uint32_t>(record + 4, static_cast<uint32_t>(topic.size()));
+            store<uint32_t>(record + 8, static_cast<uint32_t>(message.size()));
+            store<uint8_t>(record + 12, qoS);
+            store<uint8_t>(record + 13, retain ? 1 : 0);
+            store<uint16_t>(record + 14, 0);
+            store<uint64_t>(record + 16, now());
+            std::memcpy(record + spool::recordHeaderSize, topic.data(), topic.size());
+            std::memcpy(record + spool::recordHeaderSize + topic.size(), message.data(), message.size());
+
+            tail.writeOffset += recordSize;
+            store<uint32_t>(tail.data + tail.writeOffset, 0); // Stale records of a reused segment must not be recovered
+
+            depth++;
+            size += recordSize;
+        } else {
+            dropped++;
+        }
+
+        return success;
+    }
+
+    bool Spool::front(Record& record) {
+        bool found = false;
+
+        while (!found && depth > 0) {
+            const uint64_t readOffset = getReadOffset();
+
+            if (readOffset < segments.front().writeOffset) {
+                const char* data = segments.front().data + readOffset;
+
+                const uint32_t topicSize = load<uint32_t>(data + 4);
+                const uint32_t messageSize = load<uint32_t>(data + 8);
+
+                record.qoS = load<uint8_t>(data + 12);
+                record.retain = load<uint8_t>(data + 13) != 0;
+                record.timestamp = load<uint64_t>(data + 16);
+                record.topic = std::string_view(data + spool::recordHeaderSize, topicSize);
+                record.message = std::string_view(data + spool::recordHeaderSize + topicSize, messageSize);
+
+                if (maxAge > 0 && record.timestamp + maxAge * 1'000'000'000 < now()) {
+                    pop();
+                    expired++;
+                } else {
+                    found = true;
+                }
+            } else if (segments.size() > 1) { // Exhausted head segment left behind by a restart
+                closeSegment(segments.front(), true);
+                segments.pop_front();
+            } else {
+                depth = 0;
+                size = 0;
+            }
+        }
+
+        return found;
+    }
+
+    void Spool::pop() {
+        if (depth > 0) {
+            Segment& head = segments.front();
+
+            const uint64_t recordSize = load<uint32_t>(head.data + getReadOffset());
+            const uint64_t readOffset = getReadOffset() + recordSize;
+
+            depth--;
+            size -= recordSize;
+
+            if (readOffset < head.writeOffset) {
+                setReadOffset(readOffset);
+            } else if (segments.size() > 1) {
+                closeSegment(head, true);
+                segments.pop_front();
+            } else { // Reuse the only segment from its start
+                head.writeOffset = spool::segmentHeaderSize;
+                store<uint32_t>(head.data + head.writeOffset, 0);
+                setReadOffset(spool::segmentHeaderSize);
+            }
+        }
+    }
+
+    bool Spool::empty() const {
+        return depth == 0;
+    }
+
+    uint64_t Spool::getDepth() const {
+        return depth;
+    }
+
+    uint64_t Spool::getSize() const {
+        return size;
+    }
+
+    double Spool::getAge() {
+        Record record;
+
+        return front(record) ? static_cast<double>(now() - std::min(now(), record.timestamp)) / 1e9 : 0;
+    }
+
+    uint64_t Spool::getDropped() const {
+        return dropped;
+    }
+
+    uint64_t Spool::getExpired() const {
+        return expired;
+    }
+
+    bool Spool::openSegment(uint64_t number, bool create) {
+        const std::string path = getSegmentPath(number);
+
+        Segment segment;
+        segment.number = number;
+        segment.fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0644);
+
+        bool success = false;
+
+        struct stat segmentStat{};
+        if (segment.fd >= 0 && create && ::ftruncate(segment.fd, static_cast<off_t>(segmentSize)) == 0) {
+            segment.capacity = segmentSize;
+        } else if (segment.fd >= 0 && !create && ::fstat(segment.fd, &segmentStat) == 0) {
+            segment.capacity = static_cast<uint64_t>(segmentStat.st_size);
+        }
+
+        if (segment.capacity > 0) {
+            void* mapping = segment.capacity >= spool::segmentHeaderSize + sizeof(uint32_t)
+                                ? ::mmap(nullptr, segment.capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0)
+                                : MAP_FAILED;
+
+            if (mapping != MAP_FAILED) {
+                segment.data = static_cast<char*>(mapping);
+
+                if (create) { // The file is zero filled, thus it ends with its first record
+                    std::memcpy(segment.data, spool::magic, sizeof(spool::magic));
+                    store<uint32_t>(segment.data + sizeof(spool::magic), spool::formatVersion);
+                    store<uint64_t>(segment.data + spool::readOffsetPosition, spool::segmentHeaderSize);
+
+                    success = true;
+                } else if (std::memcmp(segment.data, spool::magic, sizeof(spool::magic)) == 0 &&
+                           load<uint32_t>(segment.data + sizeof(spool::magic)) == spool::formatVersion) {
+                    const uint64_t readOffset = load<uint64_t>(segment.data + spool::readOffsetPosition);
+
+                    // Recover the end of the written records
+                    while (segment.writeOffset + sizeof(uint32_t) <= segment.capacity) {
+                        const uint64_t recordSize = load<uint32_t>(segment.data + segment.writeOffset);
+
+                        if (recordSize < spool::recordHeaderSize || recordSize % 8 != 0 ||
+                            recordSize + sizeof(uint32_t) > segment.capacity - segment.writeOffset) {
+                            break;
+                        }
+
+                        if (segment.writeOffset >= readOffset) {
+                            depth++;
+                            size += recordSize;
+                        }
+
+                        segment.writeOffset += recordSize;
+                    }
+
+                    success = readOffset >= spool::segmentHeaderSize && readOffset <= segment.writeOffset;
+                }
+            }
+        }
+
+        if (success) {
+            segments.push_back(segment);
+        } else {
+            VLOG(0) << "Spool: Cannot " << (create ? "create" : "recover") << " segment '" << path << "'";
+
+            closeSegment(segment, false);
+        }
+
+        return success;
+    }
+
+    void Spool::closeSegment(Segment& segment, bool remove) {
+        if (segment.data != nullptr) {
+            ::munmap(segment.data, segment.capacity);
+            segment.data = nullptr;
+        }
+
+        if (segment.fd >= 0) {
+            ::close(segment.fd);
+            segment.fd = -1;
+        }
+
+        if (remove) {
+            ::unlink(getSegmentPath(segment.number).c_str());
+        }
+    }
+
+    void Spool::dropHead() {
+        Segment& head = segments.front();
+
+        for (uint64_t offset = getReadOffset(); offset < head.writeOffset;) {
+            const uint64_t recordSize = load<uint32_t>(head.data + offset);
+
+            depth--;
+            size -= recordSize;
+            dropped++;
+
+            offset += recordSize;
+        }
+
+        closeSegment(head, true);
+        segments.pop_front();
+    }
+
+    uint64_t Spool::getReadOffset() const {
+        return load<uint64_t>(segments.front().data + spool::readOffsetPosition);
+    }
+
+    void Spool::setReadOffset(uint64_t readOffset) {
+        store<uint64_t>(segments.front().data + spool::readOffsetPosition, readOffset);
+    }
+
+    std::string Spool::getSegmentPath(uint64_t number) const {
+        std::ostringstream path;
+        path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << number << ".spool";
+
+        return path.str();
+    }
+
+} // namespace mqtt::bridge::lib
@@ -0,0 +1,136 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MQTT_BRIDGE_LIB_SPOOL_H
+#define MQTT_BRIDGE_LIB_SPOOL_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::bridge::lib {
+
+    // Spool segment: a header followed by 8 byte aligned records in host byte order, terminated by a zero size
+    //   header = magic | u32 version | u32 reserved | u64 read offset
+    //   record = u32 size of the record | u32 topic size | u32 message size | u8 qos | u8 retain | u16 reserved | u64 timestamp
+    //            (ns since epoch) | topic | message
+    namespace spool {
+        constexpr char magic[8] = {'M', 'Q', 'B', 'S', 'P', 'O', 'O', 'L'};
+        constexpr uint32_t formatVersion = 1;
+        constexpr std::size_t readOffsetPosition = sizeof(magic) + 2 * sizeof(uint32_t);
+        constexpr std::size_t segmentHeaderSize = readOffsetPosition + sizeof(uint64_t);
+        constexpr std::size_t recordHeaderSize = 3 * sizeof(uint32_t) + 2 * sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint64_t);
+    } // namespace spool
+
+    // Store-and-forward queue of a bridge destination on disk: a ring of memory mapped segment files in a directory. When the size
+    // limit is reached the oldest segment is dropped, records older than the age limit are skipped when read. The read position is
+    // kept in the mapped head segment, thus the content survives restarts of the bridge.
+    class Spool {
+    public:
+        struct Record {
+            uint64_t timestamp = 0;
+            uint8_t qoS = 0;
+            bool retain = false;
+            std::string_view topic;
+            std::string_view message;
+        };
+
+        Spool(const std::string& directory, uint64_t maxSize, uint64_t maxAge, uint64_t segmentSize);
+
+        Spool(const Spool&) = delete;
+        Spool& operator=(const Spool&) = delete;
+
+        ~Spool();
+
+        bool isOpen() const;
+
+        bool push(std::string_view topic, std::string_view message, uint8_t qoS, bool retain);
+        bool front(Record& record); // Oldest record not expired, valid until the next push or pop
+        void pop();                 // Removes the record returned by front
+
+        bool empty() const;
+
+        uint64_t getDepth() const;
+        uint64_t getSize() const;
+        double getAge(); // Seconds since the oldest record was spooled
+        uint64_t getDropped() const;
+        uint64_t getExpired() const;
+
+    private:
+        struct Segment {
+            uint64_t number = 0;
+            int fd = -1;
+            char* data = nullptr;
+            uint64_t capacity = 0;
+            uint64_t writeOffset = spool::segmentHeaderSize;
+        };
+
+        bool openSegment(uint64_t number, bool create);
+        void closeSegment(Segment& segment, bool remove);
+        void dropHead();
+
+        uint64_t getReadOffset() const;
+        void setReadOffset(uint64_t readOffset);
+
+        std::string getSegmentPath(uint64_t number) const;
+
+        std::string directory;
+        uint64_t maxSegments;
+        uint64_t maxAge;
+        uint64_t segmentSize;
+
+        std::deque<Segment> segments;
+
+        uint64_t depth = 0;
+        uint64_t size = 0;
+        uint64_t dropped = 0;
+        uint64_t expired = 0;
+    };
+
+} // namespace mqtt::bridge::lib
+
+#endif // MQTT_BRIDGE_LIB_SPOOL_H
@@ -43,6 +43,7 @@
 #include "SocketContextFactory.h"
 #include "config.h"
 #include "lib/BridgeStore.h"
+#include "lib/Metrics.h"
 #include "lib/Mqtt.h"
 #include "lib/SSEDistributor.h"
 
@@ -567,6 +568,11 @@ int main(int argc, char* argv[]) {
         }
     });
 
+    router.get("/metrics", [] APPLICATION(req, res) {
+        res->set("Content-Type", mqtt::lib::metrics::Registry::contentType);
+        res->send(mqtt::lib::metrics::Registry::instance().renderPrometheus());
+    });
+
     router.get("/", [] APPLICATION(req, res) {
         res->redirect("/config");
     });
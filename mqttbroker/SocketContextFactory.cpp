@@ -63,9 +63,11 @@ namespace mqtt::mqttbroker {
     core::socket::stream::SocketContext* SocketContextFactory::create(core::socket::stream::SocketConnection* socketConnection) {
         return new iot::mqtt::SocketContext(
             socketConnection,
-            new mqtt::mqttbroker::lib::Mqtt(socketConnection->getConnectionName(),
-                                            broker,
-                                            utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper()));
+            new mqtt::mqttbroker::lib::Mqtt(
+                socketConnection->getConnectionName(),
+                broker,
+                utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper(),
+                utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMappingMaxChainDepth()));
     }
 
 } // namespace mqtt::mqttbroker
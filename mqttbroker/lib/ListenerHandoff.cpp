@@ -0,0 +1,341 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "ListenerHandoff.h"
+
+#include "Mqtt.h"
+#include "MqttModel.h"
+#include "WorkerFabric.h"
+
+#include <core/SNodeC.h>
+#include <core/socket/State.h>
+#include <net/un/stream/legacy/SocketClient.h>
+#include <net/un/stream/legacy/SocketServer.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <linux/filter.h>
+#include <log/Logger.h>
+#include <map>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    static const std::string takeOverRequest = "takeover "; // Followed by the fabric path of the successor
+    static const std::string drainingReply = "draining";
+
+    ListenerHandoffSocketContext::ListenerHandoffSocketContext(core::socket::stream::SocketConnection* socketConnection,
+                                                               ListenerHandoff* listenerHandoff,
+                                                               bool requesting)
+        : core::socket::stream::SocketContext(socketConnection)
+        , listenerHandoff(listenerHandoff)
+        , requesting(requesting) {
+    }
+
+    void ListenerHandoffSocketContext::sendLine(const std::string& line) const {
+        sendToPeer(line + "\n");
+    }
+
+    void ListenerHandoffSocketContext::onConnected() {
+        if (requesting) {
+            listenerHandoff->onRequestConnected(this);
+        }
+    }
+
+    void ListenerHandoffSocketContext::onDisconnected() {
+        if (requesting) {
+            listenerHandoff->onRequestDisconnected();
+        }
+    }
+
+    bool ListenerHandoffSocketContext::onSignal([[maybe_unused]] int signum) {
+        return true;
+    }
+
+    // Each side sends exactly one line
+    std::size_t ListenerHandoffSocketContext::onReceivedFromPeer() {
+        char chunk[ListenerHandoff::maxLineSize];
+
+        const std::size_t chunkLen = readFromPeer(chunk, sizeof(chunk));
+
+        if (!lineReceived) {
+            receiveBuffer.append(chunk, chunkLen);
+
+            const std::size_t lineEnd = receiveBuffer.find('\n');
+            if (lineEnd != std::string::npos) {
+                lineReceived = true;
+
+                if (requesting) {
+                    listenerHandoff->onReply(this, receiveBuffer.substr(0, lineEnd));
+                } else {
+                    listenerHandoff->onRequest(this, receiveBuffer.substr(0, lineEnd));
+                }
+            } else if (receiveBuffer.size() >= ListenerHandoff::maxLineSize) {
+                VLOG(0) << "Handoff: Control line too long. Closing";
+                close();
+            }
+        }
+
+        return chunkLen;
+    }
+
+    ListenerHandoffSocketContextFactory::ListenerHandoffSocketContextFactory(ListenerHandoff* listenerHandoff, bool requesting)
+        : listenerHandoff(listenerHandoff)
+        , requesting(requesting) {
+    }
+
+    core::socket::stream::SocketContext*
+    ListenerHandoffSocketContextFactory::create(core::socket::stream::SocketConnection* socketConnection) {
+        return new ListenerHandoffSocketContext(socketConnection, listenerHandoff, requesting);
+    }
+
+    ListenerHandoff::ListenerHandoff(const std::string& controlPath,
+                                     std::size_t drainRate,
+                                     const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker)
+        : controlPath(controlPath)
+        , fabricPath(controlPath + ".fabric-" + std::to_string(getpid()))
+        , drainRate(drainRate) {
+        WorkerFabric::instance().startHandoffHub(broker, fabricPath);
+
+        // Give the listeners of this process the time to be bound before the predecessor is asked to hand over
+        takeOverTimer = core::timer::Timer::singleshotTimer(
+            [this] {
+                takeOver();
+            },
+            takeOverDelay);
+    }
+
+    ListenerHandoff::~ListenerHandoff() {
+        takeOverTimer.cancel();
+        replyTimer.cancel();
+        drainTimer.cancel();
+    }
+
+    void ListenerHandoff::takeOver() {
+        listeners = getListeningSockets();
+
+        if (listeners.empty() && ++takeOverAttempts < maxTakeOverAttempts) {
+            takeOverTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    takeOver();
+                },
+                takeOverDelay);
+        } else if (listeners.empty()) {
+            // Taking over would make the predecessor drain while nobody accepts the reconnects. Its control socket is left alone too
+            VLOG(0) << "Handoff: No listener bound, the predecessor (if any) keeps serving";
+        } else {
+            requestHandoff();
+        }
+    }
+
+    void ListenerHandoff::requestHandoff() {
+        net::un::stream::legacy::Client<ListenerHandoffSocketContextFactory>(
+            "handoff-request",
+            [controlPath = controlPath](net::un::stream::legacy::config::ConfigSocketClient* config) {
+                config->Remote::setSunPath(controlPath);
+            },
+            this,
+            true)
+            .connect([this](const auto& socketAddress, const core::socket::State& state) {
+                VLOG(1) << "Handoff: Control socket " << socketAddress.toString() << ": " << state.what();
+
+                if (state != core::socket::State::OK) { // No predecessor
+                    listenControl();
+                }
+            });
+    }
+
+    void ListenerHandoff::listenControl() {
+        net::un::stream::legacy::Server<ListenerHandoffSocketContextFactory>(
+            "handoff",
+            [controlPath = controlPath](net::un::stream::legacy::config::ConfigSocketServer* config) {
+                config->setSunPath(controlPath);
+                config->setRetry(); // A draining predecessor holds the path until it stops
+            },
+            this,
+            false)
+            .listen([](const auto& socketAddress, const core::socket::State& state) {
+                VLOG(1) << "Handoff: Control socket listening on " << socketAddress.toString() << ": " << state.what();
+            });
+    }
+
+    void ListenerHandoff::onRequestConnected(ListenerHandoffSocketContext* socketContext) {
+        socketContext->sendLine(takeOverRequest + fabricPath);
+
+        replyTimer = core::timer::Timer::singleshotTimer(
+            [socketContext] {
+                socketContext->close();
+            },
+            replyTimeout);
+    }
+
+    // New connections are steered to this process only once the predecessor is known to drain into it
+    void ListenerHandoff::onReply(ListenerHandoffSocketContext* socketContext, const std::string& reply) {
+        replyTimer.cancel();
+
+        confirmed = reply == drainingReply;
+        if (confirmed) {
+            for (const int listenerFd : listeners) {
+                steerToNewest(listenerFd);
+            }
+
+            VLOG(1) << "Handoff: Took over from the predecessor on " << listeners.size() << " listeners";
+
+            listenControl();
+        }
+
+        socketContext->close();
+    }
+
+    // A predecessor which answered without confirming, or not in time, keeps serving. Carrying on would split the clients between two
+    // uncoupled brokers
+    void ListenerHandoff::onRequestDisconnected() {
+        replyTimer.cancel();
+
+        if (!confirmed) {
+            VLOG(0) << "Handoff: Predecessor did not confirm the handoff, giving up the upgrade";
+
+            core::SNodeC::stop();
+        }
+    }
+
+    void ListenerHandoff::onRequest(ListenerHandoffSocketContext* socketContext, const std::string& request) {
+        if (!draining && request.size() > takeOverRequest.size() && request.starts_with(takeOverRequest)) {
+            draining = true;
+
+            socketContext->sendLine(drainingReply);
+
+            VLOG(1) << "Handoff: Successor took over, draining " << MqttModel::instance().getClients().size() << " clients";
+
+            WorkerFabric::instance().joinSuccessor(request.substr(takeOverRequest.size()));
+
+            drainTimer = core::timer::Timer::intervalTimer(
+                [this] {
+                    drain();
+                },
+                1);
+        } else {
+            VLOG(0) << "Handoff: Refused " << (draining ? "a second" : "a malformed") << " handoff request";
+
+            socketContext->close();
+        }
+    }
+
+    void ListenerHandoff::drain() {
+        const std::map<std::string, Mqtt*>& clients = MqttModel::instance().getClients();
+
+        // Clients move over only while the fabric link forwards publishes and has handed the retained messages over
+        if (!WorkerFabric::instance().isLinkedToHub()) {
+            VLOG(1) << "Handoff: Waiting for the fabric link to the successor";
+        } else if (clients.empty()) {
+            drainTimer.cancel();
+
+            VLOG(1) << "Handoff: All clients drained, stopping";
+
+            core::SNodeC::stop();
+        } else {
+            // Collected first as closing may remove the client from the model
+            std::vector<Mqtt*> batch;
+            for (auto it = clients.begin(); it != clients.end() && batch.size() < drainRate; ++it) {
+                batch.push_back(it->second);
+            }
+
+            // A drained client is not gone, it reconnects to the successor
+            for (Mqtt* mqtt : batch) {
+                mqtt->dismiss();
+            }
+        }
+    }
+
+    std::vector<int> ListenerHandoff::getListeningSockets() {
+        std::vector<int> listeners;
+
+        std::error_code errorCode;
+        for (const auto& entry : std::filesystem::directory_iterator("/proc/self/fd", errorCode)) {
+            const std::string name = entry.path().filename().string();
+            const int fd = static_cast<int>(std::strtol(name.c_str(), nullptr, 10));
+
+            int acceptConn = 0;
+            int type = 0;
+            socklen_t optLen = sizeof(int);
+            sockaddr_storage address{};
+            socklen_t addressLength = sizeof(address);
+
+            if (::getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &acceptConn, &optLen) == 0 && acceptConn != 0 &&
+                ::getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &optLen) == 0 && type == SOCK_STREAM &&
+                ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0 &&
+                (address.ss_family == AF_INET || address.ss_family == AF_INET6)) {
+                listeners.push_back(fd);
+            }
+        }
+
+        return listeners;
+    }
+
+    bool ListenerHandoff::steerToNewest(int listenerFd) {
+        // The sockets of a reuseport group are indexed in bind order and the last one moves into the slot of a leaving one. With the
+        // predecessor at index 0 the successor is at index 1, and once the predecessor closed its listener the index is out of range,
+        // in which case the kernel falls back to the hash based selection among the remaining sockets. The program stays attached to
+        // the group and is thus already in place for the next upgrade
+        sock_filter code[] = {{static_cast<uint16_t>(BPF_RET | BPF_K), 0, 0, 1}};
+        const sock_fprog program{1, code};
+
+        const bool attached = ::setsockopt(listenerFd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0;
+        if (!attached) {
+            VLOG(0) << "Handoff: Cannot steer listener " << listenerFd << ": " << std::strerror(errno);
+        }
+
+        return attached;
+    }
+
+} // namespace mqtt::mqttbroker::lib
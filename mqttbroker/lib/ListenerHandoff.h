@@ -0,0 +1,167 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_LISTENERHANDOFF_H
+#define MQTTBROKER_LIB_LISTENERHANDOFF_H
+
+#include <core/socket/stream/SocketContext.h>
+#include <core/socket/stream/SocketContextFactory.h>
+#include <core/timer/Timer.h>
+
+namespace iot::mqtt::server::broker {
+    class Broker;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    class ListenerHandoff;
+
+    // One end of the control connection. The successor requests with "takeover <fabric path>\n", the predecessor confirms with
+    // "draining\n"
+    class ListenerHandoffSocketContext : public core::socket::stream::SocketContext {
+    public:
+        ListenerHandoffSocketContext(core::socket::stream::SocketConnection* socketConnection,
+                                     ListenerHandoff* listenerHandoff,
+                                     bool requesting);
+
+        void sendLine(const std::string& line) const;
+
+    private:
+        void onConnected() final;
+        void onDisconnected() final;
+        bool onSignal(int signum) final;
+        std::size_t onReceivedFromPeer() final;
+
+        ListenerHandoff* listenerHandoff;
+        bool requesting; // On the successor
+        std::string receiveBuffer;
+        bool lineReceived = false;
+    };
+
+    class ListenerHandoffSocketContextFactory : public core::socket::stream::SocketContextFactory {
+    public:
+        ListenerHandoffSocketContextFactory(ListenerHandoff* listenerHandoff, bool requesting);
+
+    private:
+        core::socket::stream::SocketContext* create(core::socket::stream::SocketConnection* socketConnection) final;
+
+        ListenerHandoff* listenerHandoff;
+        bool requesting;
+    };
+
+    // Zero-downtime upgrade of a running broker. All TCP listeners are bound with SO_REUSEPORT, so the new process binds the same
+    // ports while the old one still accepts. Once its listeners are up the new process asks the old one over the control unix socket
+    // to hand over. Only when the old process confirms, the new one attaches a reuseport program to its listeners which steers every
+    // new connection to the most recently bound socket of each port, and binds the control socket for the next upgrade as soon as the
+    // old process has released it. If the old process does not confirm, the new one stops and the old one keeps serving.
+    //
+    // While draining, both processes form a worker fabric: the old one joins the fabric of the new one, hands over its retained
+    // messages and from then on publishes are forwarded in both directions as between workers. The old process disconnects its
+    // clients gradually without publishing their Will messages, but only while the fabric link is up, and stops when the last one is
+    // gone.
+    //
+    // Known limits: Sessions are not handed over. Thus a handoff is refused with a session or retained store, and persistent sessions
+    // of the old process are lost. While draining, a client id may be connected to both processes and each process runs its own $share
+    // groups. An old process whose successor never links keeps its clients and refuses further handoffs.
+    class ListenerHandoff {
+    public:
+        ListenerHandoff(const std::string& controlPath,
+                        std::size_t drainRate,
+                        const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
+
+        ListenerHandoff(const ListenerHandoff&) = delete;
+        ListenerHandoff& operator=(const ListenerHandoff&) = delete;
+
+        ~ListenerHandoff();
+
+    private:
+        friend class ListenerHandoffSocketContext;
+
+        void takeOver();
+        void requestHandoff();
+        void listenControl();
+
+        // Successor side of the control connection
+        void onRequestConnected(ListenerHandoffSocketContext* socketContext);
+        void onReply(ListenerHandoffSocketContext* socketContext, const std::string& reply);
+        void onRequestDisconnected();
+
+        // Predecessor side of the control connection
+        void onRequest(ListenerHandoffSocketContext* socketContext, const std::string& request);
+
+        void drain();
+
+        static std::vector<int> getListeningSockets();
+        static bool steerToNewest(int listenerFd);
+
+        std::string controlPath;
+        std::string fabricPath; // Of the fabric of this process, the predecessor joins it
+        std::size_t drainRate;
+
+        std::vector<int> listeners; // Steered once the predecessor confirmed
+        bool confirmed = false;
+        bool draining = false;
+
+        core::timer::Timer takeOverTimer;
+        core::timer::Timer replyTimer;
+        core::timer::Timer drainTimer;
+
+        std::size_t takeOverAttempts = 0;
+
+        static constexpr double takeOverDelay = 1;
+        static constexpr std::size_t maxTakeOverAttempts = 10; // Waiting for the own listeners to be bound
+        static constexpr double replyTimeout = 5;
+        static constexpr std::size_t maxLineSize = 256; // Prefix, fabric path and newline
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_LISTENERHANDOFF_H
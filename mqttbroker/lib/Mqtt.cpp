@@ -43,9 +43,14 @@
 
 #include "Mqtt.h"
 
+#include "lib/Metrics.h"
 #include "lib/MqttMapper.h"
 #include "mqttbroker/lib/MqttModel.h"
+#include "mqttbroker/lib/TopicFilter.h"
+#include "mqttbroker/lib/WorkerFabric.h"
 
+#include <core/socket/stream/SocketConnection.h>
+#include <iot/mqtt/MqttContext.h>
 #include <iot/mqtt/packets/Publish.h>
 #include <iot/mqtt/packets/Subscribe.h>
 #include <iot/mqtt/packets/Unsubscribe.h>
@@ -53,25 +58,34 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <log/Logger.h>
+#include <utility>
 
 #endif
 
 namespace mqtt::mqttbroker::lib {
 
+    Mqtt::MappingChainStatistics Mqtt::mappingChainStatistics;
+
     struct Mqtt::ScheduledPublish {
         utils::Timeval when;
         std::size_t seq;
         iot::mqtt::packets::Publish publish;
         utils::Timeval delay;
+        std::vector<std::string> chain; // Topics of the mapping chain leading to the publish
     };
 
     Mqtt::Mqtt(const std::string& connectionName,
                const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker,
-               const std::shared_ptr<mqtt::lib::MqttMapper>& mqttMapper)
+               const std::shared_ptr<mqtt::lib::MqttMapper>& mqttMapper,
+               std::size_t maxMappingChainDepth)
         : iot::mqtt::server::Mqtt(connectionName, broker)
         , mqttMapper(mqttMapper)
+        , maxMappingChainDepth(maxMappingChainDepth)
         , delayedQueue(this) {
     }
 
@@ -83,12 +97,17 @@ namespace mqtt::mqttbroker::lib {
         return a.seq > b.seq;
     }
 
+    static mqtt::lib::metrics::Gauge& delayedQueueDepth = mqtt::lib::metrics::Registry::instance().gauge(
+        "mqttsuite_broker_delayed_queue_depth", "Delayed mapped publishes waiting to be published");
+
     Mqtt::DelayedQueue::DelayedQueue(Mqtt* mqtt)
         : mqtt(mqtt) {
     }
 
     Mqtt::DelayedQueue::~DelayedQueue() {
         delayTimer.cancel();
+
+        delayedQueueDepth.add(-static_cast<std::int64_t>(minHeap.size()));
     }
 
     void Mqtt::DelayedQueue::processDue() {
@@ -96,12 +115,12 @@ namespace mqtt::mqttbroker::lib {
 
         while (!empty() && top().when <= now) {
             const iot::mqtt::packets::Publish duePublish = top().publish;
+            const std::vector<std::string> chain = top().chain;
             pop();
+            delayedQueueDepth.add(-1);
 
-            mqtt->broker->publish(
-                mqtt->clientId, duePublish.getTopic(), duePublish.getMessage(), duePublish.getQoS(), duePublish.getRetain());
-
-            mqtt->onPublish(duePublish);
+            // A mapped publish, not one of the client: It continues its chain and is not accounted as received
+            mqtt->publishMappings(duePublish, chain);
         }
     }
 
@@ -124,8 +143,12 @@ namespace mqtt::mqttbroker::lib {
             delay);
     }
 
-    void Mqtt::DelayedQueue::delayPublish(const utils::Timeval& delay, const iot::mqtt::packets::Publish& publish) {
-        minHeap.push({utils::Timeval::currentTime() + delay, nextSeq++, publish, delay});
+    void Mqtt::DelayedQueue::delayPublish(const utils::Timeval& delay,
+                                          const iot::mqtt::packets::Publish& publish,
+                                          const std::vector<std::string>& chain) {
+        minHeap.push({utils::Timeval::currentTime() + delay, nextSeq++, publish, delay, chain});
+        delayedQueueDepth.add(1);
+
         armDelayTimer();
     }
 
@@ -141,6 +164,10 @@ namespace mqtt::mqttbroker::lib {
         minHeap.pop();
     }
 
+    const Mqtt::MappingChainStatistics& Mqtt::getMappingChainStatistics() {
+        return mappingChainStatistics;
+    }
+
     void Mqtt::subscribe(const std::string& topic, uint8_t qoS) {
         broker->subscribe(clientId, topic, qoS);
         onSubscribe(iot::mqtt::packets::Subscribe(0, {{topic, qoS}}));
@@ -151,46 +178,154 @@ namespace mqtt::mqttbroker::lib {
         onUnsubscribe(iot::mqtt::packets::Unsubscribe(0, {{topic, 0}}));
     }
 
+    void Mqtt::sendSharedPublish(const std::string& topic, const std::string& message, uint8_t qoS) {
+        sendPublish(topic, message, qoS, false);
+    }
+
+    // The session is deleted before closing, so releasing it on disconnect finds no active session whose Will would be published
+    void Mqtt::dismiss() {
+        dismissed = true;
+        broker->deleteSession(clientId);
+
+        getMqttContext()->getSocketConnection()->close();
+    }
+
+    // A worker knows the sessions of its own clients only, and SO_REUSEPORT may route a reconnect to any other worker
     void Mqtt::onConnect([[maybe_unused]] const iot::mqtt::packets::Connect& connect) {
-        MqttModel::instance().connectClient(this);
+        if (WorkerFabric::instance().isWorkerMode() && !getCleanSession()) {
+            VLOG(0) << "Client '" << clientId << "' rejected: Persistent sessions are not supported in worker mode";
+
+            dismiss();
+        } else {
+            MqttModel::instance().connectClient(this);
+        }
     }
 
+    static mqtt::lib::metrics::Counter& publishReceived =
+        mqtt::lib::metrics::Registry::instance().counter("mqttsuite_broker_publish_received_total", "Publishes received from clients");
+    static mqtt::lib::metrics::Histogram& publishDuration = mqtt::lib::metrics::Registry::instance().histogram(
+        "mqttsuite_broker_publish_duration_seconds", "Time spent handling a received publish including its mappings");
+
     void Mqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
+        const mqtt::lib::metrics::ScopedDuration scopedDuration(publishDuration);
+        publishReceived.inc();
+
+        MqttModel::instance().countTraffic(getClientId(), publish.getTopic(), publish.getMessage().size());
         MqttModel::instance().publishMessage(publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+        WorkerFabric::instance().forwardPublish(publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
 
         if (mqttMapper != nullptr) {
-            const auto& [immediatePublishes, scheduledPublishes] = mqttMapper->getMappings(publish);
+            publishMappings(publish);
+        }
+    }
 
-            for (const mqtt::lib::MqttMapper::ScheduledPublish& delayedPublish : scheduledPublishes) {
-                delayedQueue.delayPublish(delayedPublish.delay, delayedPublish.publish);
+    void Mqtt::publishMappings(const iot::mqtt::packets::Publish& publish, const std::vector<std::string>& inheritedChain) {
+        struct PendingPublish {
+            iot::mqtt::packets::Publish publish;
+            std::size_t depth;
+        };
+
+        // Work stack instead of recursion: Popping from the back and pushing the mapped publishes in reverse order keeps the depth-first
+        // publish order of a recursive implementation while the stack use stays constant.
+        std::vector<PendingPublish> pendingPublishes;
+        pendingPublishes.push_back({publish, inheritedChain.size()});
+
+        // Topics of the publishes leading to the one currently processed. As the matching mapping node is determined by the topic, a topic
+        // seen twice on this path is a mapping cycle.
+        std::vector<std::string> chain = inheritedChain;
+
+        if (inheritedChain.empty()) {
+            mappingChainStatistics.chains++;
+        }
+
+        while (!pendingPublishes.empty()) {
+            const PendingPublish pendingPublish = std::move(pendingPublishes.back());
+            pendingPublishes.pop_back();
+
+            const iot::mqtt::packets::Publish& currentPublish = pendingPublish.publish;
+
+            chain.resize(pendingPublish.depth);
+
+            if (pendingPublish.depth > 0) {
+                if (std::find(chain.begin(), chain.end(), currentPublish.getTopic()) != chain.end()) {
+                    mappingChainStatistics.droppedCycles++;
+
+                    VLOG(1) << "Mapping cycle detected: Dropping mapped publish to '" << currentPublish.getTopic() << "' at depth "
+                            << pendingPublish.depth;
+                    continue;
+                }
+
+                if (pendingPublish.depth > maxMappingChainDepth) {
+                    mappingChainStatistics.droppedTooDeep++;
+
+                    VLOG(1) << "Mapping chain too deep: Dropping mapped publish to '" << currentPublish.getTopic() << "' at depth "
+                            << pendingPublish.depth << " (max " << maxMappingChainDepth << ")";
+                    continue;
+                }
+
+                mappingChainStatistics.mappedPublishes++;
+                mappingChainStatistics.maxDepthSeen = std::max(mappingChainStatistics.maxDepthSeen, pendingPublish.depth);
+
+                broker->publish(
+                    clientId, currentPublish.getTopic(), currentPublish.getMessage(), currentPublish.getQoS(), currentPublish.getRetain());
+
+                MqttModel::instance().publishMessage(
+                    currentPublish.getTopic(), currentPublish.getMessage(), currentPublish.getQoS(), currentPublish.getRetain());
+                WorkerFabric::instance().forwardPublish(
+                    currentPublish.getTopic(), currentPublish.getMessage(), currentPublish.getQoS(), currentPublish.getRetain());
             }
 
-            for (const iot::mqtt::packets::Publish& immediatePublish : immediatePublishes) {
-                broker->publish(clientId,
-                                immediatePublish.getTopic(),
-                                immediatePublish.getMessage(),
-                                immediatePublish.getQoS(),
-                                immediatePublish.getRetain());
+            chain.push_back(currentPublish.getTopic());
+
+            const auto& [immediatePublishes, scheduledPublishes] = mqttMapper->getMappings(currentPublish);
+
+            for (const mqtt::lib::MqttMapper::ScheduledPublish& delayedPublish : scheduledPublishes) {
+                delayedQueue.delayPublish(delayedPublish.delay, delayedPublish.publish, chain);
+            }
 
-                onPublish(immediatePublish);
+            for (auto immediatePublishIt = immediatePublishes.rbegin(); immediatePublishIt != immediatePublishes.rend();
+                 ++immediatePublishIt) {
+                pendingPublishes.push_back({*immediatePublishIt, pendingPublish.depth + 1});
             }
         }
     }
 
+    // Each worker would run its own consumer groups and deliver a message once per worker instead of once per group. SNode.C has already
+    // granted the subscription in the SUBACK when onSubscribe is called, thus the client is disconnected rather than left believing it
+    // is subscribed
     void Mqtt::onSubscribe(const iot::mqtt::packets::Subscribe& subscribe) {
+        bool rejected = false;
+
         for (const iot::mqtt::Topic& topic : subscribe.getTopics()) {
-            MqttModel::instance().subscribeClient(clientId, topic.getName(), topic.getQoS());
+            std::string group;
+            std::string filter;
+
+            if (WorkerFabric::instance().isWorkerMode() && parseSharedSubscription(topic.getName(), group, filter)) {
+                VLOG(0) << "Client '" << clientId << "' disconnected: Shared subscription '" << topic.getName()
+                        << "' not supported in worker mode";
+
+                broker->unsubscribe(clientId, topic.getName());
+                rejected = true;
+            } else {
+                MqttModel::instance().subscribeClient(clientId, topic.getName(), topic.getQoS());
+                WorkerFabric::instance().subscribe(clientId, topic.getName());
+            }
+        }
+
+        if (rejected) {
+            getMqttContext()->getSocketConnection()->close();
         }
     }
 
     void Mqtt::onUnsubscribe(const iot::mqtt::packets::Unsubscribe& unsubscribe) {
         for (const std::string& topic : unsubscribe.getTopics()) {
             MqttModel::instance().unsubscribeClient(clientId, topic);
+            WorkerFabric::instance().unsubscribe(clientId, topic);
         }
     }
 
     void Mqtt::onDisconnected() {
-        MqttModel::instance().disconnectClient(clientId);
+        MqttModel::instance().disconnectClient(clientId, !getCleanSession() && !dismissed);
     }
 
 } // namespace mqtt::mqttbroker::lib
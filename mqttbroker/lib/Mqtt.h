@@ -74,13 +74,29 @@ namespace mqtt::mqttbroker::lib {
 
     class Mqtt : public iot::mqtt::server::Mqtt {
     public:
+        struct MappingChainStatistics {
+            uint64_t chains = 0;
+            uint64_t mappedPublishes = 0;
+            uint64_t droppedCycles = 0;
+            uint64_t droppedTooDeep = 0;
+            std::size_t maxDepthSeen = 0;
+        };
+
         explicit Mqtt(const std::string& connectionName,
                       const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker,
-                      const std::shared_ptr<mqtt::lib::MqttMapper>& mqttMapper);
+                      const std::shared_ptr<mqtt::lib::MqttMapper>& mqttMapper,
+                      std::size_t maxMappingChainDepth);
 
         void subscribe(const std::string& topic, uint8_t qoS);
         void unsubscribe(const std::string& topic);
 
+        void sendSharedPublish(const std::string& topic, const std::string& message, uint8_t qoS); // To this member of a $share group
+
+        // Closes the connection without publishing the Will message. The session is discarded
+        void dismiss();
+
+        static const MappingChainStatistics& getMappingChainStatistics();
+
     private:
         struct ScheduledPublish;
 
@@ -93,7 +109,9 @@ namespace mqtt::mqttbroker::lib {
             explicit DelayedQueue(Mqtt* mqtt);
             ~DelayedQueue();
 
-            void delayPublish(const utils::Timeval& delay, const iot::mqtt::packets::Publish& publish);
+            void delayPublish(const utils::Timeval& delay,
+                              const iot::mqtt::packets::Publish& publish,
+                              const std::vector<std::string>& chain);
 
             bool empty() const;
             const ScheduledPublish& top() const;
@@ -115,8 +133,15 @@ namespace mqtt::mqttbroker::lib {
         void onUnsubscribe(const iot::mqtt::packets::Unsubscribe& unsubscribe) final;
         void onDisconnected() final;
 
+        // A chain inherited from a delayed mapped publish continues its cycle detection and depth limit
+        void publishMappings(const iot::mqtt::packets::Publish& publish, const std::vector<std::string>& inheritedChain = {});
+
         std::shared_ptr<mqtt::lib::MqttMapper> mqttMapper;
+        std::size_t maxMappingChainDepth;
         DelayedQueue delayedQueue;
+        bool dismissed = false;
+
+        static MappingChainStatistics mappingChainStatistics;
     };
 
 } // namespace mqtt::mqttbroker::lib
@@ -55,8 +55,10 @@
 
 // IWYU pragma: no_include <nlohmann/detail/json_ref.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <ctime>
+#include <exception>
 #include <functional>
 #include <iomanip>
 #include <log/Logger.h>
@@ -155,25 +157,13 @@ namespace mqtt::mqttbroker::lib {
         j = {{"topic", release.topic}};
     }
 
-    MqttModel::EventReceiver::EventReceiver(std::uint64_t id, const std::shared_ptr<express::Response>& response)
-        : id(id)
-        , response(response)
-        , heartbeatTimer(core::timer::Timer::intervalTimer(
-              [response] {
-                  if (response->isConnected()) {
-                      response->sendFragment(":keep-alive");
-                      response->sendFragment();
-                  }
-              },
-              39)) {
-    }
-
-    MqttModel::EventReceiver::~EventReceiver() {
-        heartbeatTimer.cancel();
+    MqttModel::MqttModel()
+        : onlineSinceTimePoint(std::chrono::system_clock::now())
+        , journalEpoch(std::to_string(std::chrono::duration_cast<std::chrono::seconds>(onlineSinceTimePoint.time_since_epoch()).count())) {
     }
 
-    MqttModel::MqttModel()
-        : onlineSinceTimePoint(std::chrono::system_clock::now()) {
+    MqttModel::~MqttModel() {
+        trafficTopTimer.cancel();
     }
 
     MqttModel& MqttModel::instance() {
@@ -183,18 +173,28 @@ namespace mqtt::mqttbroker::lib {
     }
 
     void MqttModel::addEventReceiver(const std::shared_ptr<express::Response>& response,
-                                     [[maybe_unused]] const std::string& lastEventId,
+                                     const std::string& lastEventId,
                                      const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
-        const std::uint64_t eventReceiverId = nextEventReceiverId++;
-
-        eventReceiverList.emplace_back(eventReceiverId, response);
+        const std::uint64_t eventReceiverId = sseDistributor.addEventReceiver(response);
 
         response->getSocketContext()->setOnDisconnected([this, eventReceiverId]() {
-            eventReceiverList.remove_if([eventReceiverId](const EventReceiver& eventReceiver) {
-                return eventReceiver.getId() == eventReceiverId;
-            });
+            sseDistributor.removeEventReceiver(eventReceiverId);
+
+            if (sseDistributor.empty() && trafficTopTimerRunning) {
+                trafficTopTimer.cancel();
+                trafficTopTimerRunning = false;
+            }
         });
 
+        if (!trafficTopTimerRunning) {
+            trafficTopTimer = core::timer::Timer::intervalTimer(
+                [this] {
+                    sseDistributor.sendEvent(getTrafficTop(trafficTopSize).dump(), "traffic-top", "");
+                },
+                trafficTopInterval);
+            trafficTopTimerRunning = true;
+        }
+
         /*
             {
                 "title": "MQTTBroker",
@@ -218,7 +218,7 @@ namespace mqtt::mqttbroker::lib {
                 "duration": "2 days, 03:45:12"
             }
         */
-        sendJsonEvent(response,
+        sendJsonEvent(eventReceiverId,
                       {
                           {"title", "MQTTBroker"},
                           {"creator", {{"name", "Volker Christian"}, {"url", "https://github.com/VolkerChristian"}}},
@@ -228,56 +228,174 @@ namespace mqtt::mqttbroker::lib {
                           {"since", onlineSince()},
                           {"duration", onlineDuration()},
                       },
-                      "ui-initialize",
-                      std::to_string(id++));
+                      "ui-initialize");
+
+        if (!resumeFrom(eventReceiverId, lastEventId)) {
+            sendSnapshot(eventReceiverId, broker);
+        }
+    }
 
+    // Compacted snapshot: the current state instead of the event history. Only the closing event carries an id, the one of the newest
+    // journaled event, so that a reconnect after an interrupted snapshot gets a new snapshot
+    void MqttModel::sendSnapshot(std::uint64_t eventReceiverId, const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
         for (const auto& modelMapEntry : modelMap) {
-            sendJsonEvent(response, modelMapEntry.second, "client-connected", std::to_string(id++));
+            sendJsonEvent(eventReceiverId, modelMapEntry.second, "client-connected");
         }
 
         for (const auto& [topic, clients] : broker->getSubscriptionTree()) {
             for (const auto& client : clients) {
-                sendJsonEvent(response, subscribe{topic, client.first, client.second}, "client-subscribed", std::to_string(id++));
+                sendJsonEvent(eventReceiverId, subscribe{topic, client.first, client.second}, "client-subscribed");
             }
         }
 
         for (const auto& [topic, retained] : broker->getRetainTree()) {
-            sendJsonEvent(response, retaine{topic, retained.first, retained.second}, "retained-message-set", std::to_string(id++));
+            sendJsonEvent(eventReceiverId, retaine{topic, retained.first, retained.second}, "retained-message-set");
+        }
+
+        sendJsonEvent(eventReceiverId, {{"lastEventId", formatEventId(id)}}, "snapshot-complete", formatEventId(id));
+    }
+
+    bool MqttModel::resumeFrom(std::uint64_t eventReceiverId, const std::string& lastEventId) {
+        bool resumed = false;
+
+        const std::string::size_type separator = lastEventId.find('-');
+        if (separator != std::string::npos && lastEventId.substr(0, separator) == journalEpoch) {
+            try {
+                const std::uint64_t sequence = std::stoull(lastEventId.substr(separator + 1));
+
+                // Resumable if nothing happened since or if the first missed event is still in the journal
+                if (sequence == id || (sequence < id && !journal.empty() && journal.front().sequence <= sequence + 1)) {
+                    for (const JournalEntry& journalEntry : journal) {
+                        if (journalEntry.sequence > sequence) {
+                            sseDistributor.sendEvent(
+                                eventReceiverId, journalEntry.data, journalEntry.event, formatEventId(journalEntry.sequence));
+                        }
+                    }
+
+                    resumed = true;
+
+                    VLOG(1) << "Server sent events: Resumed from " << lastEventId << " replaying " << (id - sequence) << " events";
+                }
+            } catch (const std::exception&) {
+                // Malformed id: fall back to a snapshot
+            }
         }
+
+        return resumed;
+    }
+
+    std::string MqttModel::formatEventId(std::uint64_t sequence) const {
+        return journalEpoch + "-" + std::to_string(sequence);
     }
 
     void MqttModel::connectClient(Mqtt* mqtt) {
         modelMap.emplace(mqtt->getClientId(), mqtt);
+        sharedSubscriptions.setOnline(mqtt->getClientId(), true);
 
-        sendJsonEvent(mqtt, "client-connected", std::to_string(id++));
+        sendJsonEvent(mqtt, "client-connected");
     }
 
-    void MqttModel::disconnectClient(const std::string& clientId) {
+    // A persistent session keeps its $share subscriptions in the broker without resubscribing on reconnect, thus its membership is
+    // kept as well
+    void MqttModel::disconnectClient(const std::string& clientId, bool keepSession) {
         if (modelMap.contains(clientId)) {
-            sendJsonEvent(modelMap[clientId], "client-disconnected", std::to_string(id++));
+            sendJsonEvent(modelMap[clientId], "client-disconnected");
 
             modelMap.erase(clientId);
+            if (keepSession) {
+                sharedSubscriptions.setOnline(clientId, false);
+            } else {
+                sharedSubscriptions.removeClient(clientId);
+            }
         }
     }
 
     void MqttModel::subscribeClient(const std::string& clientId, const std::string& topic, const uint8_t qos) {
-        sendJsonEvent(subscribe{topic, clientId, qos}, "client-subscribed", std::to_string(id++));
+        sharedSubscriptions.subscribe(clientId, topic, qos);
+
+        sendJsonEvent(subscribe{topic, clientId, qos}, "client-subscribed");
     }
 
     void MqttModel::unsubscribeClient(const std::string& clientId, const std::string& topic) {
-        sendJsonEvent(unsubscribe{clientId, topic}, "client-unsubscribed", std::to_string(id++));
+        sharedSubscriptions.unsubscribe(clientId, topic);
+
+        sendJsonEvent(unsubscribe{clientId, topic}, "client-unsubscribed");
     }
 
     void MqttModel::publishMessage(const std::string& topic, const std::string& message, uint8_t qoS, bool retain) {
+        sharedSubscriptions.publish(topic, [this, &topic, &message, qoS](const std::string& clientId, uint8_t subscriptionQoS) {
+            Mqtt* mqtt = getMqtt(clientId);
+
+            if (mqtt != nullptr) {
+                mqtt->sendSharedPublish(topic, message, std::min(qoS, subscriptionQoS));
+            }
+        });
+
         if (retain) {
+            if (onRetainChanged) {
+                onRetainChanged(topic, message, qoS);
+            }
+
             if (!message.empty()) {
-                sendJsonEvent(retaine{topic, message, qoS}, "retained-message-set", std::to_string(id++));
+                if (retainedTopicsTracked && retainedTopics.insert(topic).second) {
+                    statistics.retainedMessages++;
+                }
+
+                sendJsonEvent(retaine{topic, message, qoS}, "retained-message-set");
             } else {
-                sendJsonEvent(release{topic}, "retained-message-deleted", std::to_string(id++));
+                if (retainedTopicsTracked && retainedTopics.erase(topic) > 0) {
+                    statistics.retainedMessages--;
+                }
+
+                sendJsonEvent(release{topic}, "retained-message-deleted");
+            }
+        }
+    }
+
+    void MqttModel::countTraffic(const std::string& clientId, const std::string& topic, std::size_t bytes) {
+        statistics.messagesReceived++;
+        statistics.bytesReceived += bytes;
+
+        trafficAnalytics.count(clientId, topic, bytes);
+    }
+
+    nlohmann::json MqttModel::getTrafficTop(std::size_t n) {
+        return trafficAnalytics.getTop(n);
+    }
+
+    void MqttModel::setOnRetainChanged(const std::function<void(const std::string&, const std::string&, uint8_t)>& onRetainChanged) {
+        this->onRetainChanged = onRetainChanged;
+    }
+
+    void MqttModel::setSharedSubscriptionStrategy(SharedSubscriptions::Strategy strategy) {
+        sharedSubscriptions.setStrategy(strategy);
+    }
+
+    void MqttModel::restoreSharedSubscriptions(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
+        for (const auto& [topicFilter, clients] : broker->getSubscriptionTree()) {
+            for (const auto& [clientId, qoS] : clients) {
+                sharedSubscriptions.subscribe(clientId, topicFilter, qoS, false);
+            }
+        }
+    }
+
+    // Seeds the retained topics once from the broker, e.g. those restored from the session store. From then on publishMessage keeps
+    // the count up to date
+    void MqttModel::trackRetainedTopics(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
+        if (!retainedTopicsTracked) {
+            for (const auto& [topic, retained] : broker->getRetainTree()) {
+                retainedTopics.insert(topic);
             }
+            statistics.retainedMessages = retainedTopics.size();
+
+            retainedTopicsTracked = true;
         }
     }
 
+    const MqttModel::Statistics& MqttModel::getStatistics() const {
+        return statistics;
+    }
+
     const std::map<std::string, Mqtt*>& MqttModel::getClients() const {
         return modelMap;
     }
@@ -301,41 +419,28 @@ namespace mqtt::mqttbroker::lib {
         return durationToString(onlineSinceTimePoint);
     }
 
-    void MqttModel::sendEvent(const std::shared_ptr<express::Response>& response,
-                              const std::string& data,
-                              const std::string& event,
-                              const std::string& id) {
-        if (response->isConnected()) {
-            if (!event.empty()) {
-                response->sendFragment("event:" + event);
-            }
-            if (!id.empty()) {
-                response->sendFragment("id:" + id);
-            }
-            response->sendFragment("data:" + data);
-            response->sendFragment();
-        }
-    }
-
-    void MqttModel::sendJsonEvent(const std::shared_ptr<express::Response>& response,
+    void MqttModel::sendJsonEvent(std::uint64_t eventReceiverId,
                                   const nlohmann::json& json,
                                   const std::string& event,
                                   const std::string& id) {
-        sendEvent(response, json.dump(), event, id);
+        sseDistributor.sendEvent(eventReceiverId, json.dump(), event, id);
     }
 
-    void MqttModel::sendEvent(const std::string& data, const std::string& event, const std::string& id) const {
-        for (auto& eventReceiver : eventReceiverList) {
-            if (const auto& response = eventReceiver.response.lock()) {
-                sendEvent(response, data, event, id);
-            }
-        }
-    }
+    void MqttModel::sendJsonEvent(const nlohmann::json& json, const std::string& event) {
+        const std::string data = json.dump();
+        const std::uint64_t sequence = ++id;
+
+        VLOG(0) << "Server sent event: " << event << "\n" << data;
 
-    void MqttModel::sendJsonEvent(const nlohmann::json& json, const std::string& event, const std::string& id) const {
-        VLOG(0) << "Server sent event: " << event << "\n" << json.dump(4);
+        sseDistributor.sendEvent(data, event, formatEventId(sequence));
 
-        sendEvent(json.dump(), event, id);
+        journal.push_back({sequence, event, data});
+        journalSize += event.size() + data.size();
+
+        while (!journal.empty() && (journal.size() > maxJournalEntries || journalSize > maxJournalSize)) {
+            journalSize -= journal.front().event.size() + journal.front().data.size();
+            journal.pop_front();
+        }
     }
 
     std::string MqttModel::timePointToString(const std::chrono::time_point<std::chrono::system_clock>& timePoint) {
@@ -42,6 +42,10 @@
 #ifndef MQTTBROKER_LIB_MQTTMODEL_H
 #define MQTTBROKER_LIB_MQTTMODEL_H
 
+#include "SSEDistributor.h"
+#include "SharedSubscriptions.h"
+#include "TrafficAnalytics.h"
+
 #include <core/timer/Timer.h>
 
 namespace mqtt::mqttbroker::lib {
@@ -61,12 +65,15 @@ namespace iot::mqtt {
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <list>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <nlohmann/json_fwd.hpp>
 #include <string>
+#include <unordered_set>
 
 #endif
 
@@ -74,26 +81,20 @@ namespace mqtt::mqttbroker::lib {
 
     class MqttModel {
     private:
-        class EventReceiver {
-        public:
-            EventReceiver(std::uint64_t id, const std::shared_ptr<express::Response>& response);
-
-            ~EventReceiver();
-
-            std::uint64_t getId() const {
-                return id;
-            }
-
-            std::uint64_t id;
-            std::weak_ptr<express::Response> response;
+        MqttModel();
 
-            core::timer::Timer heartbeatTimer;
+    public:
+        struct Statistics {
+            uint64_t messagesReceived = 0;
+            uint64_t bytesReceived = 0;
+            std::size_t retainedMessages = 0; // Only maintained after trackRetainedTopics()
         };
 
-    private:
-        MqttModel();
+        MqttModel(const MqttModel&) = delete;
+        MqttModel& operator=(const MqttModel&) = delete;
+
+        ~MqttModel();
 
-    public:
         static MqttModel& instance();
 
         void addEventReceiver(const std::shared_ptr<express::Response>& response,
@@ -101,10 +102,22 @@ namespace mqtt::mqttbroker::lib {
                               const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
 
         void connectClient(Mqtt* mqtt);
-        void disconnectClient(const std::string& clientId);
+        void disconnectClient(const std::string& clientId, bool keepSession);
         void subscribeClient(const std::string& clientId, const std::string& topic, const uint8_t qos);
         void unsubscribeClient(const std::string& clientId, const std::string& topic);
         void publishMessage(const std::string& topic, const std::string& message, uint8_t qoS, bool retain);
+        void countTraffic(const std::string& clientId, const std::string& topic, std::size_t bytes);
+
+        nlohmann::json getTrafficTop(std::size_t n);
+
+        // Called for every retained message set or deleted (empty message), e.g. to persist them
+        void setOnRetainChanged(const std::function<void(const std::string&, const std::string&, uint8_t)>& onRetainChanged);
+
+        void setSharedSubscriptionStrategy(SharedSubscriptions::Strategy strategy);
+        void restoreSharedSubscriptions(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker); // Of restored sessions
+
+        void trackRetainedTopics(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
+        const Statistics& getStatistics() const;
 
         const std::map<std::string, Mqtt*>& getClients() const;
 
@@ -114,16 +127,16 @@ namespace mqtt::mqttbroker::lib {
         std::string onlineDuration() const;
 
     private:
-        static void sendEvent(const std::shared_ptr<express::Response>& response,
-                              const std::string& data,
-                              const std::string& event,
-                              const std::string& id);
-        static void sendJsonEvent(const std::shared_ptr<express::Response>& response,
-                                  const nlohmann::json& json,
-                                  const std::string& event = "",
-                                  const std::string& id = "");
-        void sendEvent(const std::string& data, const std::string& event = "", const std::string& id = "") const;
-        void sendJsonEvent(const nlohmann::json& json, const std::string& event = "", const std::string& id = "") const;
+        void sendJsonEvent(std::uint64_t eventReceiverId,
+                           const nlohmann::json& json,
+                           const std::string& event = "",
+                           const std::string& id = "");
+        void sendJsonEvent(const nlohmann::json& json, const std::string& event); // Broadcast and journal
+
+        void sendSnapshot(std::uint64_t eventReceiverId, const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
+        bool resumeFrom(std::uint64_t eventReceiverId, const std::string& lastEventId);
+
+        std::string formatEventId(std::uint64_t sequence) const;
 
         static std::string timePointToString(const std::chrono::time_point<std::chrono::system_clock>& timePoint);
         static std::string
@@ -131,10 +144,40 @@ namespace mqtt::mqttbroker::lib {
                          const std::chrono::time_point<std::chrono::system_clock>& later = std::chrono::system_clock::now());
 
         std::map<std::string, Mqtt*> modelMap;
-        std::list<EventReceiver> eventReceiverList;
+        SSEDistributor sseDistributor;
         std::chrono::time_point<std::chrono::system_clock> onlineSinceTimePoint;
-        std::uint64_t nextEventReceiverId = 0;
-        uint64_t id = 0;
+        uint64_t id = 0; // Sequence of the newest journaled event
+
+        // Ring journal of broadcast events for Last-Event-ID resume. Event ids are "<epoch>-<sequence>" so that ids of a previous
+        // broker run never match
+        struct JournalEntry {
+            std::uint64_t sequence;
+            std::string event;
+            std::string data;
+        };
+
+        std::deque<JournalEntry> journal;
+        std::size_t journalSize = 0; // Bytes of event names and data, which may carry large payloads
+        std::string journalEpoch;
+
+        static constexpr std::size_t maxJournalEntries = 16384;
+        static constexpr std::size_t maxJournalSize = 16 * 1024 * 1024;
+
+        // Heavy hitters over the last minute, pushed to the dashboards as unjournaled "traffic-top" event while any is connected
+        TrafficAnalytics trafficAnalytics;
+        core::timer::Timer trafficTopTimer;
+        bool trafficTopTimerRunning = false;
+
+        static constexpr double trafficTopInterval = 10;
+        static constexpr std::size_t trafficTopSize = 10;
+
+        std::function<void(const std::string&, const std::string&, uint8_t)> onRetainChanged;
+
+        SharedSubscriptions sharedSubscriptions;
+
+        Statistics statistics;
+        std::unordered_set<std::string> retainedTopics;
+        bool retainedTopicsTracked = false;
     };
 
 } // namespace mqtt::mqttbroker::lib
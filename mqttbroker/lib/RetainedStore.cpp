@@ -0,0 +1,512 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "RetainedStore.h"
+
+#include <iot/mqtt/server/broker/Broker.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <log/Logger.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    static constexpr char snapshotMagic[8] = {'M', 'Q', 'S', 'R', 'E', 'T', 'S', '\0'};
+
+    static uint32_t checksum(std::string_view data) {
+        // FNV-1a 32
+        uint32_t hash = 0x811c9dc5U;
+
+        for (const char c : data) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x01000193U;
+        }
+
+        return hash;
+    }
+
+    static bool writeAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t written = ::write(fd, data.data(), data.size());
+
+            if (written < 0 && errno != EINTR) {
+                return false;
+            }
+            if (written > 0) {
+                data.remove_prefix(static_cast<std::size_t>(written));
+            }
+        }
+
+        return true;
+    }
+
+    // Makes a created or renamed file in the directory of path durable
+    static bool syncDirectory(const std::string& path) {
+        const std::filesystem::path parentPath = std::filesystem::path(path).parent_path();
+
+        const int fd = ::open(parentPath.empty() ? "." : parentPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        const bool synced = fd >= 0 && ::fsync(fd) == 0;
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        return synced;
+    }
+
+    RetainedStore::RetainedStore(const std::string& storePath)
+        : storePath(storePath) {
+    }
+
+    RetainedStore::~RetainedStore() {
+        flushTimer.cancel();
+        compactionTimer.cancel();
+
+        flush();
+
+        if (walFd >= 0) {
+            ::close(walFd);
+        }
+    }
+
+    std::size_t RetainedStore::restore(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
+        this->broker = broker;
+
+        removeStaleSnapshots();
+
+        // Views into the mapped snapshot and the WAL contents, which stay alive until everything is published
+        std::unordered_map<std::string_view, std::pair<std::string_view, uint8_t>> retained;
+
+        void* snapshotMap = MAP_FAILED;
+        uint64_t snapshotGeneration = 0;
+
+        const int fd = ::open(getSnapshotPath().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            struct stat st {};
+            if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(SnapshotHeader)) {
+                snapshotSize = static_cast<std::size_t>(st.st_size);
+
+                snapshotMap = ::mmap(nullptr, snapshotSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (snapshotMap != MAP_FAILED) {
+                    ::madvise(snapshotMap, snapshotSize, MADV_SEQUENTIAL);
+
+                    const char* bytes = static_cast<const char*>(snapshotMap);
+
+                    SnapshotHeader header{};
+                    std::memcpy(&header, bytes, sizeof(SnapshotHeader));
+
+                    if (std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0 || header.formatVersion != formatVersion) {
+                        VLOG(0) << "Retained store: Unknown snapshot format in '" << getSnapshotPath() << "'";
+                    } else {
+                        snapshotGeneration = header.generation;
+                        // The header is not covered by a checksum, thus the count is bounded by what fits into the file
+                        retained.reserve(static_cast<std::size_t>(
+                            std::min<uint64_t>(header.recordCount, (snapshotSize - sizeof(SnapshotHeader)) / minRecordSize)));
+
+                        const std::string_view records(bytes + sizeof(SnapshotHeader), snapshotSize - sizeof(SnapshotHeader));
+                        if (parseRecords(records,
+                                         [&retained](Operation, uint8_t qoS, std::string_view topic, std::string_view message) {
+                                             retained[topic] = {message, qoS};
+                                         }) != records.size()) {
+                            VLOG(0) << "Retained store: Snapshot '" << getSnapshotPath() << "' is damaged, restored its intact part";
+                        }
+                    }
+                } else {
+                    VLOG(0) << "Retained store: Mapping '" << getSnapshotPath() << "' failed: " << std::strerror(errno);
+                }
+            }
+
+            ::close(fd);
+        }
+
+        std::list<std::string> walContents; // Stable elements, as the views refer into them
+        for (const auto& [walGeneration, walPath] : listWals()) {
+            generation = std::max(generation, walGeneration + 1);
+
+            if (walGeneration >= snapshotGeneration) {
+                std::ifstream walFile(walPath, std::ios::binary);
+                walContents.emplace_back(std::istreambuf_iterator<char>(walFile), std::istreambuf_iterator<char>());
+
+                // A torn record at the end of a WAL is the write in progress at a crash and ends the replay of that file
+                parseRecords(walContents.back(),
+                             [&retained](Operation operation, uint8_t qoS, std::string_view topic, std::string_view message) {
+                                 if (operation == Set) {
+                                     retained[topic] = {message, qoS};
+                                 } else {
+                                     retained.erase(topic);
+                                 }
+                             });
+            }
+        }
+        generation = std::max(generation, snapshotGeneration);
+
+        removeWalsBefore(snapshotGeneration);
+
+        // Stores written before $-topics were skipped may still contain them
+        std::erase_if(retained, [](const auto& retainedMessage) {
+            return retainedMessage.first.starts_with('$');
+        });
+
+        for (const auto& [topic, retainedMessage] : retained) {
+            broker->publish("", std::string(topic), std::string(retainedMessage.first), retainedMessage.second, true);
+        }
+
+        const std::size_t restored = retained.size();
+
+        if (snapshotMap != MAP_FAILED) {
+            ::munmap(snapshotMap, snapshotSize);
+        }
+
+        VLOG(1) << "Retained store: Restored " << restored << " retained messages from '" << storePath << "'";
+
+        if (!walContents.empty()) {
+            compact(); // Fold the replayed WALs into a new snapshot, opens the WAL of the next generation
+        } else {
+            openWal();
+        }
+
+        return restored;
+    }
+
+    void RetainedStore::retain(const std::string& topic, const std::string& message, uint8_t qoS) {
+        if (!topic.starts_with('$')) {
+            appendRecord(pendingRecords, message.empty() ? Delete : Set, topic, message, qoS);
+
+            if (pendingRecords.size() >= maxPendingRecordsSize) {
+                flush();
+            } else {
+                scheduleFlush();
+            }
+        }
+    }
+
+    void RetainedStore::appendRecord(
+        std::string& buffer, Operation operation, std::string_view topic, std::string_view message, uint8_t qoS) {
+        const std::size_t recordPosition = buffer.size();
+        const uint32_t topicLength = static_cast<uint32_t>(topic.size());
+
+        buffer.resize(recordPosition + 2 * sizeof(uint32_t)); // Body length and checksum, filled in below
+        buffer.push_back(operation);
+        buffer.push_back(static_cast<char>(qoS));
+        buffer.append(reinterpret_cast<const char*>(&topicLength), sizeof(topicLength));
+        buffer.append(topic);
+        buffer.append(message);
+
+        const std::string_view body = std::string_view(buffer).substr(recordPosition + 2 * sizeof(uint32_t));
+        const uint32_t bodyLength = static_cast<uint32_t>(body.size());
+        const uint32_t bodyChecksum = checksum(body);
+
+        std::memcpy(buffer.data() + recordPosition, &bodyLength, sizeof(bodyLength));
+        std::memcpy(buffer.data() + recordPosition + sizeof(bodyLength), &bodyChecksum, sizeof(bodyChecksum));
+    }
+
+    std::size_t RetainedStore::parseRecords(std::string_view data, const RecordHandler& onRecord) {
+        std::size_t position = 0;
+
+        while (data.size() - position >= 2 * sizeof(uint32_t)) {
+            uint32_t bodyLength = 0;
+            uint32_t bodyChecksum = 0;
+            std::memcpy(&bodyLength, data.data() + position, sizeof(bodyLength));
+            std::memcpy(&bodyChecksum, data.data() + position + sizeof(bodyLength), sizeof(bodyChecksum));
+
+            if (data.size() - position - 2 * sizeof(uint32_t) < bodyLength || bodyLength < 2 + sizeof(uint32_t)) {
+                break;
+            }
+
+            const std::string_view body = data.substr(position + 2 * sizeof(uint32_t), bodyLength);
+
+            uint32_t topicLength = 0;
+            std::memcpy(&topicLength, body.data() + 2, sizeof(topicLength));
+
+            const Operation operation = static_cast<Operation>(body[0]);
+            if (checksum(body) != bodyChecksum || (operation != Set && operation != Delete) ||
+                body.size() - 2 - sizeof(uint32_t) < topicLength) {
+                break;
+            }
+
+            onRecord(operation,
+                     static_cast<uint8_t>(body[1]),
+                     body.substr(2 + sizeof(uint32_t), topicLength),
+                     body.substr(2 + sizeof(uint32_t) + topicLength));
+
+            position += 2 * sizeof(uint32_t) + bodyLength;
+        }
+
+        return position;
+    }
+
+    std::string RetainedStore::getSnapshotPath() const {
+        return storePath + ".snapshot";
+    }
+
+    std::string RetainedStore::getWalPath(uint64_t generation) const {
+        return storePath + ".wal." + std::to_string(generation);
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> RetainedStore::listWals() const {
+        namespace fs = std::filesystem;
+
+        std::vector<std::pair<uint64_t, std::string>> wals;
+
+        const fs::path basePath(storePath);
+        const std::string walPrefix = basePath.filename().string() + ".wal.";
+
+        std::error_code ec;
+        for (const fs::directory_entry& entry :
+             fs::directory_iterator(basePath.has_parent_path() ? basePath.parent_path() : fs::path("."), ec)) {
+            const std::string fileName = entry.path().filename().string();
+
+            if (fileName.starts_with(walPrefix) && fileName.size() > walPrefix.size() &&
+                fileName.find_first_not_of("0123456789", walPrefix.size()) == std::string::npos) {
+                wals.emplace_back(std::stoull(fileName.substr(walPrefix.size())), entry.path().string());
+            }
+        }
+
+        std::sort(wals.begin(), wals.end());
+
+        return wals;
+    }
+
+    uint64_t RetainedStore::readSnapshotGeneration() const {
+        SnapshotHeader header{};
+
+        std::ifstream snapshotFile(getSnapshotPath(), std::ios::binary);
+        snapshotFile.read(reinterpret_cast<char*>(&header), sizeof(SnapshotHeader));
+
+        return snapshotFile && std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) == 0 ? header.generation : 0;
+    }
+
+    void RetainedStore::removeStaleSnapshots() const {
+        namespace fs = std::filesystem;
+
+        const fs::path snapshotPath(getSnapshotPath());
+        const std::string tmpPrefix = snapshotPath.filename().string() + ".tmp.";
+
+        // Left behind by a compaction child killed together with a previous broker run
+        std::error_code ec;
+        for (const fs::directory_entry& entry :
+             fs::directory_iterator(snapshotPath.has_parent_path() ? snapshotPath.parent_path() : fs::path("."), ec)) {
+            if (entry.path().filename().string().starts_with(tmpPrefix)) {
+                VLOG(1) << "Retained store: Removing stale snapshot '" << entry.path().string() << "'";
+
+                fs::remove(entry.path(), ec);
+            }
+        }
+    }
+
+    void RetainedStore::removeWalsBefore(uint64_t generation) const {
+        for (const auto& [walGeneration, walPath] : listWals()) {
+            if (walGeneration < generation) {
+                std::remove(walPath.c_str());
+            }
+        }
+    }
+
+    bool RetainedStore::openWal() {
+        if (walFd >= 0) {
+            ::close(walFd);
+        }
+
+        walFd = ::open(getWalPath(generation).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        walSize = 0;
+
+        if (walFd < 0) {
+            VLOG(0) << "Retained store: Cannot open '" << getWalPath(generation) << "': " << std::strerror(errno);
+        } else if (!syncDirectory(getWalPath(generation))) {
+            VLOG(0) << "Retained store: Syncing the directory of '" << getWalPath(generation) << "' failed: " << std::strerror(errno);
+        }
+
+        return walFd >= 0;
+    }
+
+    void RetainedStore::scheduleFlush() {
+        if (!flushScheduled) {
+            flushScheduled = true;
+
+            flushTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    flushScheduled = false;
+                    flush();
+                },
+                0);
+        }
+    }
+
+    void RetainedStore::flush() {
+        if (!pendingRecords.empty() && walFd >= 0) {
+            // One sync per event loop iteration commits all retained changes of that iteration together
+            if (writeAll(walFd, pendingRecords) && ::fdatasync(walFd) == 0) {
+                walSize += pendingRecords.size();
+            } else {
+                VLOG(0) << "Retained store: Writing or syncing '" << getWalPath(generation) << "' failed: " << std::strerror(errno);
+            }
+            pendingRecords.clear();
+
+            if (walSize > std::max(minCompactionWalSize, snapshotSize)) {
+                compact();
+            }
+        }
+    }
+
+    void RetainedStore::compact() {
+        if (compactionPid < 0 && broker != nullptr) {
+            flush();
+
+            // The child sees the retain tree as of now, which equals the snapshot plus all WALs up to the current generation
+            generation++;
+            openWal();
+
+            const pid_t pid = fork();
+
+            if (pid == 0) {
+                _exit(writeSnapshot(getSnapshotPath(), generation, broker) ? EXIT_SUCCESS : EXIT_FAILURE);
+            } else if (pid > 0) {
+                compactionPid = pid;
+
+                compactionTimer = core::timer::Timer::intervalTimer(
+                    [this] {
+                        checkCompaction();
+                    },
+                    compactionPollInterval);
+
+                VLOG(1) << "Retained store: Compacting into generation " << generation << " (pid " << pid << ")";
+            } else {
+                VLOG(0) << "Retained store: Forking the compaction failed: " << std::strerror(errno);
+            }
+        }
+    }
+
+    void RetainedStore::checkCompaction() {
+        int status = 0;
+        const pid_t pid = ::waitpid(compactionPid, &status, WNOHANG);
+
+        bool finished = pid != 0;
+        if (pid < 0 && errno == ECHILD) {
+            // SIGCHLD is ignored, e.g. in worker mode, and the child is reaped automatically. It is done once it is gone
+            finished = ::kill(compactionPid, 0) != 0 && errno == ESRCH;
+        }
+
+        // The snapshot header tells whether the compaction succeeded
+        if (finished) {
+            compactionTimer.cancel();
+            compactionPid = -1;
+
+            const uint64_t snapshotGeneration = readSnapshotGeneration();
+            if (snapshotGeneration == generation) {
+                removeWalsBefore(snapshotGeneration);
+
+                struct stat st {};
+                snapshotSize = ::stat(getSnapshotPath().c_str(), &st) == 0 ? static_cast<std::size_t>(st.st_size) : 0;
+
+                VLOG(1) << "Retained store: Compaction into generation " << snapshotGeneration << " done";
+            } else {
+                VLOG(0) << "Retained store: Compaction into generation " << generation << " failed";
+            }
+        }
+    }
+
+    bool RetainedStore::writeSnapshot(const std::string& snapshotPath,
+                                      uint64_t generation,
+                                      const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker) {
+        // Per generation, so a child still running from an earlier compaction never writes into the same file
+        const std::string tmpPath = snapshotPath + ".tmp." + std::to_string(generation);
+
+        const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        bool success = fd >= 0;
+
+        if (success) {
+            const auto retainTree = broker->getRetainTree();
+
+            SnapshotHeader header{};
+            std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+            header.formatVersion = formatVersion;
+            header.generation = generation;
+            // The $-topics, e.g. the $SYS/broker statistics, belong to the running broker and would be stale after a restart
+            header.recordCount = static_cast<uint64_t>(std::count_if(retainTree.begin(), retainTree.end(), [](const auto& retained) {
+                return !retained.first.starts_with('$');
+            }));
+
+            std::string buffer(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+            for (const auto& [topic, retained] : retainTree) {
+                if (topic.starts_with('$')) {
+                    continue;
+                }
+                appendRecord(buffer, Set, topic, retained.first, retained.second);
+
+                if (buffer.size() >= maxPendingRecordsSize) {
+                    success = success && writeAll(fd, buffer);
+                    buffer.clear();
+                }
+            }
+            success = success && writeAll(fd, buffer) && ::fsync(fd) == 0;
+
+            ::close(fd);
+
+            // Renamed only when complete, so a crash leaves the previous snapshot intact
+            success = success && std::rename(tmpPath.c_str(), snapshotPath.c_str()) == 0 && syncDirectory(snapshotPath);
+            if (!success) {
+                std::remove(tmpPath.c_str());
+            }
+        }
+
+        return success;
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,143 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_RETAINEDSTORE_H
+#define MQTTBROKER_LIB_RETAINEDSTORE_H
+
+#include <core/timer/Timer.h>
+
+namespace iot::mqtt::server::broker {
+    class Broker;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    // Persists the retained messages as write-ahead log plus snapshot, both sequences of checksummed records. Every retained change is
+    // appended to the WAL of the current generation, written and synced once per event loop iteration. When the WAL grows beyond the
+    // snapshot a forked child writes a new snapshot of the broker's retain tree, covering all generations before the one started at
+    // the fork, and the covered WALs are removed afterwards. A restart maps the snapshot, replays the remaining WALs and publishes the
+    // result. Retained $-topics are owned by the running broker and not persisted.
+    class RetainedStore {
+    public:
+        explicit RetainedStore(const std::string& storePath);
+
+        RetainedStore(const RetainedStore&) = delete;
+        RetainedStore& operator=(const RetainedStore&) = delete;
+
+        ~RetainedStore();
+
+        std::size_t restore(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
+
+        void retain(const std::string& topic, const std::string& message, uint8_t qoS); // An empty message deletes
+
+    private:
+        struct SnapshotHeader {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t reserved;
+            uint64_t generation; // The snapshot contains all WALs of older generations
+            uint64_t recordCount;
+        };
+
+        enum Operation : char { Set = 'S', Delete = 'D' };
+
+        using RecordHandler = std::function<void(Operation, uint8_t, std::string_view, std::string_view)>;
+
+        static void appendRecord(std::string& buffer, Operation operation, std::string_view topic, std::string_view message, uint8_t qoS);
+        static std::size_t parseRecords(std::string_view data, const RecordHandler& onRecord); // Returns the length of the valid prefix
+
+        std::string getSnapshotPath() const;
+        std::string getWalPath(uint64_t generation) const;
+        std::vector<std::pair<uint64_t, std::string>> listWals() const; // Sorted by generation
+        uint64_t readSnapshotGeneration() const;
+        void removeWalsBefore(uint64_t generation) const;
+        void removeStaleSnapshots() const;
+
+        bool openWal();
+        void scheduleFlush();
+        void flush();
+
+        void compact();
+        void checkCompaction();
+        static bool writeSnapshot(const std::string& snapshotPath,
+                                  uint64_t generation,
+                                  const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker);
+
+        std::string storePath;
+        std::shared_ptr<iot::mqtt::server::broker::Broker> broker;
+
+        uint64_t generation = 1;
+        int walFd = -1;
+        std::size_t walSize = 0;
+        std::size_t snapshotSize = 0;
+
+        std::string pendingRecords;
+        core::timer::Timer flushTimer;
+        bool flushScheduled = false;
+
+        pid_t compactionPid = -1;
+        core::timer::Timer compactionTimer;
+
+        static constexpr uint32_t formatVersion = 1;
+        static constexpr std::size_t minRecordSize = 2 * sizeof(uint32_t) + 2 + sizeof(uint32_t); // Empty topic and message
+        static constexpr std::size_t minCompactionWalSize = 64 * 1024 * 1024;
+        static constexpr std::size_t maxPendingRecordsSize = 4 * 1024 * 1024; // Written at once when exceeded
+        static constexpr double compactionPollInterval = 1;
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_RETAINEDSTORE_H
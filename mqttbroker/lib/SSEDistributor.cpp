@@ -0,0 +1,222 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "SSEDistributor.h"
+
+#include <core/socket/stream/SocketConnection.h>
+#include <express/Response.h>
+#include <web/http/server/SocketContext.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <utility>
+#include <log/Logger.h>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    SSEDistributor::EventReceiver::EventReceiver(std::uint64_t id, const std::shared_ptr<express::Response>& response)
+        : id(id)
+        , response(response) {
+    }
+
+    SSEDistributor::~SSEDistributor() {
+        flushTimer.cancel();
+        heartbeatTimer.cancel();
+    }
+
+    std::uint64_t SSEDistributor::addEventReceiver(const std::shared_ptr<express::Response>& response) {
+        const std::uint64_t eventReceiverId = nextEventReceiverId++;
+
+        eventReceiverList.emplace_back(eventReceiverId, response);
+
+        if (!heartbeatTimerRunning) {
+            heartbeatTimer = core::timer::Timer::intervalTimer(
+                [this] {
+                    heartbeat();
+                },
+                heartbeatInterval);
+            heartbeatTimerRunning = true;
+        }
+
+        return eventReceiverId;
+    }
+
+    void SSEDistributor::removeEventReceiver(std::uint64_t eventReceiverId) {
+        eventReceiverList.remove_if([eventReceiverId](const EventReceiver& eventReceiver) {
+            return eventReceiver.getId() == eventReceiverId;
+        });
+
+        if (eventReceiverList.empty() && heartbeatTimerRunning) {
+            heartbeatTimer.cancel();
+            heartbeatTimerRunning = false;
+        }
+    }
+
+    bool SSEDistributor::empty() const {
+        return eventReceiverList.empty();
+    }
+
+    void SSEDistributor::sendEvent(const std::string& data, const std::string& event, const std::string& id) {
+        if (!eventReceiverList.empty()) {
+            const Frame frame = makeFrame(data, event, id);
+
+            for (EventReceiver& eventReceiver : eventReceiverList) {
+                enqueue(eventReceiver, frame, true);
+            }
+        }
+    }
+
+    void SSEDistributor::sendEvent(std::uint64_t eventReceiverId,
+                                   const std::string& data,
+                                   const std::string& event,
+                                   const std::string& id) {
+        auto eventReceiverIt =
+            std::find_if(eventReceiverList.begin(), eventReceiverList.end(), [eventReceiverId](const EventReceiver& eventReceiver) {
+                return eventReceiver.getId() == eventReceiverId;
+            });
+
+        if (eventReceiverIt != eventReceiverList.end()) {
+            enqueue(*eventReceiverIt, makeFrame(data, event, id), false);
+        }
+    }
+
+    SSEDistributor::Frame SSEDistributor::makeFrame(const std::string& data, const std::string& event, const std::string& id) {
+        std::string frame;
+        frame.reserve(data.size() + event.size() + id.size() + 20);
+
+        if (!event.empty()) {
+            frame += "event:" + event + "\n";
+        }
+        if (!id.empty()) {
+            frame += "id:" + id + "\n";
+        }
+        frame += "data:" + data + "\n";
+
+        return std::make_shared<const std::string>(std::move(frame));
+    }
+
+    void SSEDistributor::enqueue(EventReceiver& eventReceiver, const Frame& frame, bool limited) {
+        if (!eventReceiver.closing) {
+            if (limited && eventReceiver.pendingFrames.size() >= maxPendingFrames) {
+                markSlow(eventReceiver, "too many pending frames");
+            } else {
+                eventReceiver.pendingFrames.push_back(frame);
+            }
+
+            scheduleFlush();
+        }
+    }
+
+    void SSEDistributor::scheduleFlush() {
+        if (!flushScheduled) {
+            flushScheduled = true;
+
+            // Fires in the next event loop iteration: everything queued until then goes out in one write per receiver
+            flushTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    flushScheduled = false;
+                    flush();
+                },
+                0);
+        }
+    }
+
+    void SSEDistributor::flush() {
+        std::vector<std::shared_ptr<express::Response>> slowResponses;
+        std::string batch;
+
+        for (EventReceiver& eventReceiver : eventReceiverList) {
+            const std::shared_ptr<express::Response> response = eventReceiver.response.lock();
+
+            if (response && response->isConnected()) {
+                const core::socket::stream::SocketConnection* socketConnection = response->getSocketContext()->getSocketConnection();
+
+                if (!eventReceiver.closing && !eventReceiver.pendingFrames.empty() &&
+                    socketConnection->getTotalQueued() - socketConnection->getTotalSent() > maxBacklogBytes) {
+                    markSlow(eventReceiver, "socket does not drain");
+                }
+
+                if (eventReceiver.closing) {
+                    slowResponses.push_back(response);
+                } else if (!eventReceiver.pendingFrames.empty()) {
+                    batch.clear();
+                    for (const Frame& frame : eventReceiver.pendingFrames) {
+                        if (!batch.empty()) {
+                            batch += '\n';
+                        }
+                        batch += *frame;
+                    }
+
+                    response->sendFragment(batch); // Appends the blank line terminating the last event
+                }
+            }
+
+            eventReceiver.pendingFrames.clear();
+        }
+
+        // Closed after the loop as closing may remove receivers via onDisconnected
+        for (const std::shared_ptr<express::Response>& response : slowResponses) {
+            response->getSocketContext()->getSocketConnection()->close();
+        }
+    }
+
+    void SSEDistributor::heartbeat() {
+        for (const EventReceiver& eventReceiver : eventReceiverList) {
+            if (const std::shared_ptr<express::Response> response = eventReceiver.response.lock()) {
+                if (!eventReceiver.closing && response->isConnected()) {
+                    response->sendFragment(":keep-alive\n");
+                }
+            }
+        }
+    }
+
+    void SSEDistributor::markSlow(EventReceiver& eventReceiver, const std::string& reason) {
+        eventReceiver.closing = true;
+        eventReceiver.pendingFrames.clear();
+
+        VLOG(1) << "SSE: Disconnecting slow event receiver " << eventReceiver.getId() << ": " << reason;
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,131 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_SSEDISTRIBUTOR_H
+#define MQTTBROKER_LIB_SSEDISTRIBUTOR_H
+
+#include <core/timer/Timer.h>
+
+namespace express {
+    class Response;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    // Fans server sent events out to all dashboard connections. Each event is serialized once into a shared frame, frames queued during
+    // one event loop iteration are written with one sendFragment per receiver, and one interval timer sends the heartbeat to everyone.
+    // Receivers whose socket does not drain are disconnected; the browser reconnects and gets a fresh replay.
+    class SSEDistributor {
+    private:
+        using Frame = std::shared_ptr<const std::string>;
+
+        class EventReceiver {
+        public:
+            EventReceiver(std::uint64_t id, const std::shared_ptr<express::Response>& response);
+
+            std::uint64_t getId() const {
+                return id;
+            }
+
+            std::uint64_t id;
+            std::weak_ptr<express::Response> response;
+
+            std::vector<Frame> pendingFrames;
+            bool closing = false;
+        };
+
+    public:
+        SSEDistributor() = default;
+
+        SSEDistributor(const SSEDistributor&) = delete;
+        SSEDistributor& operator=(const SSEDistributor&) = delete;
+
+        ~SSEDistributor();
+
+        std::uint64_t addEventReceiver(const std::shared_ptr<express::Response>& response);
+        void removeEventReceiver(std::uint64_t eventReceiverId);
+
+        bool empty() const;
+
+        // Broadcast to all receivers
+        void sendEvent(const std::string& data, const std::string& event, const std::string& id);
+        // Unicast, e.g. for the initial replay. Not subject to maxPendingFrames
+        void sendEvent(std::uint64_t eventReceiverId, const std::string& data, const std::string& event, const std::string& id);
+
+        static constexpr std::size_t maxPendingFrames = 4096;        // Per receiver and loop iteration
+        static constexpr std::size_t maxBacklogBytes = 16 * 1024 * 1024; // Queued in the socket but not yet sent
+        static constexpr double heartbeatInterval = 39;
+
+    private:
+        static Frame makeFrame(const std::string& data, const std::string& event, const std::string& id);
+
+        void enqueue(EventReceiver& eventReceiver, const Frame& frame, bool limited);
+        void scheduleFlush();
+        void flush();
+        void heartbeat();
+
+        static void markSlow(EventReceiver& eventReceiver, const std::string& reason); // Closed by the next flush
+
+        std::list<EventReceiver> eventReceiverList;
+        std::uint64_t nextEventReceiverId = 0;
+
+        core::timer::Timer flushTimer;
+        bool flushScheduled = false;
+
+        core::timer::Timer heartbeatTimer;
+        bool heartbeatTimerRunning = false;
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_SSEDISTRIBUTOR_H
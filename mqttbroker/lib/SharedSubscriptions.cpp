@@ -0,0 +1,181 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "SharedSubscriptions.h"
+
+#include "TopicFilter.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <iterator>
+#include <log/Logger.h>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    static uint64_t hash(const std::string& clientId, const std::string& topic) {
+        // FNV-1a 64
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for (const std::string* part : {&clientId, &topic}) {
+            for (const char c : *part) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 0x100000001b3ULL;
+            }
+            hash ^= 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    void SharedSubscriptions::setStrategy(Strategy strategy) {
+        this->strategy = strategy;
+    }
+
+    bool SharedSubscriptions::subscribe(const std::string& clientId, const std::string& topicFilter, uint8_t qoS, bool online) {
+        std::string groupName;
+        std::string filter;
+
+        const bool shared = parseSharedSubscription(topicFilter, groupName, filter);
+
+        if (shared) {
+            Group& group = groups[topicFilter];
+            group.filter = filter;
+
+            auto memberIt = std::find_if(group.members.begin(), group.members.end(), [&clientId](const Member& member) {
+                return member.clientId == clientId;
+            });
+
+            if (memberIt != group.members.end()) {
+                memberIt->qoS = qoS;
+                memberIt->online = online;
+            } else {
+                group.members.push_back({clientId, qoS, online});
+            }
+
+            VLOG(1) << "Shared subscription: '" << clientId << "' joined '" << topicFilter << "' (" << group.members.size() << " members)";
+        }
+
+        return shared;
+    }
+
+    bool SharedSubscriptions::unsubscribe(const std::string& clientId, const std::string& topicFilter) {
+        auto groupIt = groups.find(topicFilter);
+        const bool shared = groupIt != groups.end();
+
+        if (shared) {
+            std::erase_if(groupIt->second.members, [&clientId](const Member& member) {
+                return member.clientId == clientId;
+            });
+
+            if (groupIt->second.members.empty()) {
+                groups.erase(groupIt);
+            }
+        }
+
+        return shared;
+    }
+
+    void SharedSubscriptions::removeClient(const std::string& clientId) {
+        for (auto groupIt = groups.begin(); groupIt != groups.end();) {
+            std::erase_if(groupIt->second.members, [&clientId](const Member& member) {
+                return member.clientId == clientId;
+            });
+
+            groupIt = groupIt->second.members.empty() ? groups.erase(groupIt) : std::next(groupIt);
+        }
+    }
+
+    void SharedSubscriptions::setOnline(const std::string& clientId, bool online) {
+        for (auto& [topicFilter, group] : groups) {
+            for (Member& member : group.members) {
+                if (member.clientId == clientId) {
+                    member.online = online;
+                }
+            }
+        }
+    }
+
+    void SharedSubscriptions::publish(const std::string& topic,
+                                      const std::function<void(const std::string& clientId, uint8_t qoS)>& deliver) {
+        for (auto& [topicFilter, group] : groups) {
+            if (topicFilterMatches(group.filter, topic)) {
+                const Member* member = select(group, topic);
+
+                if (member != nullptr) {
+                    deliver(member->clientId, member->qoS);
+                }
+            }
+        }
+    }
+
+    const SharedSubscriptions::Member* SharedSubscriptions::select(Group& group, const std::string& topic) const {
+        const Member* selected = nullptr;
+
+        if (strategy == Strategy::RoundRobin) {
+            for (std::size_t tries = 0; tries < group.members.size() && selected == nullptr; ++tries) {
+                const Member& member = group.members[group.next++ % group.members.size()];
+
+                if (member.online) {
+                    selected = &member;
+                }
+            }
+        } else {
+            uint64_t highestScore = 0;
+
+            for (const Member& member : group.members) {
+                const uint64_t score = hash(member.clientId, topic);
+
+                if (member.online && (selected == nullptr || score > highestScore)) {
+                    highestScore = score;
+                    selected = &member;
+                }
+            }
+        }
+
+        return selected;
+    }
+
+} // namespace mqtt::mqttbroker::lib
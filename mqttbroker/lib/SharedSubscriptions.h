@@ -0,0 +1,101 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_SHAREDSUBSCRIPTIONS_H
+#define MQTTBROKER_LIB_SHAREDSUBSCRIPTIONS_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    // Consumer groups of "$share/<group>/<filter>" subscriptions. The broker itself keeps the subscription as an ordinary, never
+    // matching filter; a publish matching <filter> is handed to exactly one connected member of each group instead. A member leaving
+    // the group, e.g. by disconnecting, fails its share over to the remaining members. Members with a persistent session stay in the
+    // group while offline but are skipped, as are messages of a group without an online member.
+    class SharedSubscriptions {
+    public:
+        enum class Strategy {
+            RoundRobin, // Members in turn
+            Sticky      // Same topic, same member as long as the membership does not change (rendezvous hashing)
+        };
+
+        void setStrategy(Strategy strategy);
+
+        // False if not a shared subscription
+        bool subscribe(const std::string& clientId, const std::string& topicFilter, uint8_t qoS, bool online = true);
+        bool unsubscribe(const std::string& clientId, const std::string& topicFilter);
+        void removeClient(const std::string& clientId);
+        void setOnline(const std::string& clientId, bool online);
+
+        void publish(const std::string& topic, const std::function<void(const std::string& clientId, uint8_t qoS)>& deliver);
+
+    private:
+        struct Member {
+            std::string clientId;
+            uint8_t qoS;
+            bool online;
+        };
+
+        struct Group {
+            std::string filter;
+            std::vector<Member> members;
+            std::size_t next = 0;
+        };
+
+        const Member* select(Group& group, const std::string& topic) const; // Nullptr if no member is online
+
+        Strategy strategy = Strategy::RoundRobin;
+        std::map<std::string, Group> groups; // Keyed by the full "$share/<group>/<filter>"
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_SHAREDSUBSCRIPTIONS_H
@@ -0,0 +1,125 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "SysTopicPublisher.h"
+
+#include "Mqtt.h"
+#include "MqttModel.h"
+
+#include <iot/mqtt/server/broker/Broker.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstdio>
+#include <log/Logger.h>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    SysTopicPublisher::SysTopicPublisher(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker, double interval)
+        : broker(broker)
+        , lastPublishTimePoint(std::chrono::steady_clock::now()) {
+        MqttModel::instance().trackRetainedTopics(broker);
+
+        publishTimer = core::timer::Timer::intervalTimer(
+            [this] {
+                publishStatistics();
+            },
+            interval);
+
+        VLOG(1) << "Publishing $SYS topics every " << interval << " seconds";
+    }
+
+    SysTopicPublisher::~SysTopicPublisher() {
+        publishTimer.cancel();
+    }
+
+    void SysTopicPublisher::publishStatistics() {
+        const MqttModel& mqttModel = MqttModel::instance();
+        const MqttModel::Statistics& statistics = mqttModel.getStatistics();
+        const uint64_t mappedPublishes = Mqtt::getMappingChainStatistics().mappedPublishes;
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - lastPublishTimePoint).count();
+
+        publish("uptime", mqttModel.onlineDuration());
+        publish("clients/connected", std::to_string(mqttModel.getClients().size()));
+        publish("messages/received", std::to_string(statistics.messagesReceived));
+        publish("bytes/received", std::to_string(statistics.bytesReceived));
+        publish("load/messages/received/persecond", formatLoad(statistics.messagesReceived - lastMessagesReceived, seconds));
+        publish("load/bytes/received/persecond", formatLoad(statistics.bytesReceived - lastBytesReceived, seconds));
+        publish("retained messages/count", std::to_string(statistics.retainedMessages));
+        publish("subscriptions/count", std::to_string(countSubscriptions()));
+        publish("mapping/publishes", std::to_string(mappedPublishes));
+        publish("load/mapping/publishes/persecond", formatLoad(mappedPublishes - lastMappedPublishes, seconds));
+
+        lastMessagesReceived = statistics.messagesReceived;
+        lastBytesReceived = statistics.bytesReceived;
+        lastMappedPublishes = mappedPublishes;
+        lastPublishTimePoint = now;
+    }
+
+    // The broker keeps no subscription counter. Unlike the retain tree the subscription tree carries no payloads, so walking it once per
+    // interval is cheap
+    std::size_t SysTopicPublisher::countSubscriptions() const {
+        std::size_t subscriptions = 0;
+
+        for (const auto& [topic, clients] : broker->getSubscriptionTree()) {
+            subscriptions += clients.size();
+        }
+
+        return subscriptions;
+    }
+
+    void SysTopicPublisher::publish(const std::string& topic, const std::string& value) {
+        broker->publish("", "$SYS/broker/" + topic, value, 0, true);
+    }
+
+    std::string SysTopicPublisher::formatLoad(uint64_t delta, double seconds) {
+        char load[32];
+        std::snprintf(load, sizeof(load), "%.2f", seconds > 0 ? static_cast<double>(delta) / seconds : 0.0);
+
+        return load;
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,117 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TopicFilter.h"
+
+namespace mqtt::mqttbroker::lib {
+
+    bool topicFilterMatches(std::string_view topicFilter, std::string_view topic) {
+        // Wildcards on the first level do not match topics starting with '$'
+        bool matches = topic.empty() || topic[0] != '$' || (!topicFilter.empty() && topicFilter[0] != '+' && topicFilter[0] != '#');
+
+        while (matches) {
+            const std::size_t filterLevelEnd = topicFilter.find('/');
+            const std::size_t topicLevelEnd = topic.find('/');
+            const std::string_view filterLevel = topicFilter.substr(0, filterLevelEnd);
+
+            if (filterLevel == "#") {
+                break;
+            }
+
+            matches = filterLevel == "+" || filterLevel == topic.substr(0, topicLevelEnd);
+
+            if (filterLevelEnd == std::string_view::npos || topicLevelEnd == std::string_view::npos) {
+                if (filterLevelEnd != topicLevelEnd) {
+                    // Only "a/#" matches "a" as well
+                    matches = matches && filterLevelEnd != std::string_view::npos && topicFilter.substr(filterLevelEnd + 1) == "#";
+                }
+                break;
+            }
+
+            topicFilter.remove_prefix(filterLevelEnd + 1);
+            topic.remove_prefix(topicLevelEnd + 1);
+        }
+
+        return matches;
+    }
+
+    bool isValidTopicFilter(std::string_view topicFilter) {
+        bool valid = !topicFilter.empty();
+
+        while (valid) {
+            const std::size_t levelEnd = topicFilter.find('/');
+            const std::string_view level = topicFilter.substr(0, levelEnd);
+
+            valid = (level.find('#') == std::string_view::npos || (level == "#" && levelEnd == std::string_view::npos)) &&
+                    (level.find('+') == std::string_view::npos || level == "+");
+
+            if (levelEnd == std::string_view::npos) {
+                break;
+            }
+
+            topicFilter.remove_prefix(levelEnd + 1);
+        }
+
+        return valid;
+    }
+
+    bool parseSharedSubscription(std::string_view topicFilter, std::string& group, std::string& filter) {
+        static constexpr std::string_view sharePrefix = "$share/";
+
+        bool shared = topicFilter.starts_with(sharePrefix);
+
+        if (shared) {
+            topicFilter.remove_prefix(sharePrefix.size());
+
+            const std::size_t groupEnd = topicFilter.find('/');
+            shared = groupEnd != std::string_view::npos && groupEnd > 0 && groupEnd + 1 < topicFilter.size() &&
+                     topicFilter.substr(0, groupEnd).find_first_of("+#") == std::string_view::npos;
+
+            if (shared) {
+                group = topicFilter.substr(0, groupEnd);
+                filter = topicFilter.substr(groupEnd + 1);
+            }
+        }
+
+        return shared;
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,242 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "TrafficAnalytics.h"
+
+#include <nlohmann/json.hpp>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <utility>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    SpaceSaving::SpaceSaving(std::size_t capacity)
+        : capacity(std::max<std::size_t>(capacity, 1)) {
+        heap.reserve(this->capacity);
+        positions.reserve(this->capacity);
+    }
+
+    void SpaceSaving::add(const std::string& key, std::uint64_t weight) {
+        auto positionIt = positions.find(key);
+
+        if (positionIt != positions.end()) {
+            heap[positionIt->second].count += weight;
+            siftDown(positionIt->second);
+        } else if (heap.size() < capacity) {
+            heap.push_back({key, weight, 0});
+            positions.emplace(key, heap.size() - 1);
+
+            // A new entry can be smaller than its parents
+            for (std::size_t position = heap.size() - 1; position > 0 && heap[position].count < heap[(position - 1) / 2].count;
+                 position = (position - 1) / 2) {
+                swapEntries(position, (position - 1) / 2);
+            }
+        } else {
+            // Evict the minimum: the newcomer inherits its count as error
+            positions.erase(heap[0].key);
+
+            heap[0].error = heap[0].count;
+            heap[0].count += weight;
+            heap[0].key = key;
+            positions.emplace(key, 0);
+
+            siftDown(0);
+        }
+    }
+
+    void SpaceSaving::clear() {
+        heap.clear();
+        positions.clear();
+    }
+
+    const std::vector<SpaceSaving::Entry>& SpaceSaving::getEntries() const {
+        return heap;
+    }
+
+    bool SpaceSaving::contains(const std::string& key) const {
+        return positions.contains(key);
+    }
+
+    bool SpaceSaving::full() const {
+        return heap.size() == capacity;
+    }
+
+    std::uint64_t SpaceSaving::minCount() const {
+        return full() ? heap[0].count : 0;
+    }
+
+    void SpaceSaving::siftDown(std::size_t position) {
+        for (;;) {
+            const std::size_t left = 2 * position + 1;
+            const std::size_t right = left + 1;
+            std::size_t smallest = position;
+
+            if (left < heap.size() && heap[left].count < heap[smallest].count) {
+                smallest = left;
+            }
+            if (right < heap.size() && heap[right].count < heap[smallest].count) {
+                smallest = right;
+            }
+            if (smallest == position) {
+                break;
+            }
+
+            swapEntries(position, smallest);
+            position = smallest;
+        }
+    }
+
+    void SpaceSaving::swapEntries(std::size_t a, std::size_t b) {
+        std::swap(heap[a], heap[b]);
+        positions[heap[a].key] = a;
+        positions[heap[b].key] = b;
+    }
+
+    TrafficAnalytics::Slot::Slot(std::size_t capacity)
+        : sketches(SketchCount, SpaceSaving(capacity)) {
+    }
+
+    TrafficAnalytics::TrafficAnalytics(std::size_t capacity,
+                                       std::size_t prefixDepth,
+                                       std::chrono::seconds slotDuration,
+                                       std::size_t slotCount)
+        : prefixDepth(prefixDepth)
+        , slotDuration(slotDuration)
+        , slots(std::max<std::size_t>(slotCount, 1), Slot(capacity))
+        , startTime(std::chrono::steady_clock::now()) {
+    }
+
+    void TrafficAnalytics::advance() {
+        const std::uint64_t slotNumber = static_cast<std::uint64_t>((std::chrono::steady_clock::now() - startTime) / slotDuration);
+
+        // Clear every slot the window moved past, at most all of them
+        for (std::uint64_t skipped = 0; currentSlotNumber < slotNumber && skipped < slots.size(); ++skipped) {
+            ++currentSlotNumber;
+
+            for (SpaceSaving& sketch : slots[currentSlotNumber % slots.size()].sketches) {
+                sketch.clear();
+            }
+        }
+        currentSlotNumber = slotNumber;
+    }
+
+    void TrafficAnalytics::count(const std::string& clientId, const std::string& topic, std::size_t bytes) {
+        advance();
+
+        std::vector<SpaceSaving>& sketches = slots[currentSlotNumber % slots.size()].sketches;
+
+        sketches[TopicMessages].add(topic, 1);
+        sketches[TopicBytes].add(topic, bytes);
+        sketches[ClientMessages].add(clientId, 1);
+        sketches[ClientBytes].add(clientId, bytes);
+
+        // Prefixes "a/#", "a/b/#", ... up to prefixDepth levels, only those shorter than the topic itself
+        std::string::size_type separator = 0;
+        for (std::size_t depth = 0; depth < prefixDepth && (separator = topic.find('/', separator)) != std::string::npos; ++depth) {
+            const std::string prefix = topic.substr(0, separator) + "/#";
+
+            sketches[PrefixMessages].add(prefix, 1);
+            sketches[PrefixBytes].add(prefix, bytes);
+
+            ++separator;
+        }
+    }
+
+    nlohmann::json TrafficAnalytics::getTop(Sketch sketch, std::size_t n) const {
+        struct Merged {
+            std::uint64_t count = 0;
+            std::uint64_t error = 0;
+        };
+
+        std::unordered_map<std::string, Merged> merged;
+        for (const Slot& slot : slots) {
+            for (const SpaceSaving::Entry& entry : slot.sketches[sketch].getEntries()) {
+                merged[entry.key].count += entry.count;
+                merged[entry.key].error += entry.error;
+            }
+        }
+
+        // A key not tracked in a full slot may still have had up to that slot's minimum there
+        for (auto& [key, mergedEntry] : merged) {
+            for (const Slot& slot : slots) {
+                const SpaceSaving& slotSketch = slot.sketches[sketch];
+
+                if (slotSketch.full() && !slotSketch.contains(key)) {
+                    mergedEntry.count += slotSketch.minCount();
+                    mergedEntry.error += slotSketch.minCount();
+                }
+            }
+        }
+
+        std::vector<std::pair<std::string, Merged>> top(merged.begin(), merged.end());
+        const std::size_t topSize = std::min(n, top.size());
+        std::partial_sort(top.begin(), top.begin() + static_cast<std::ptrdiff_t>(topSize), top.end(), [](const auto& a, const auto& b) {
+            return a.second.count > b.second.count || (a.second.count == b.second.count && a.first < b.first);
+        });
+        top.resize(topSize);
+
+        nlohmann::json topJson = nlohmann::json::array();
+        for (const auto& [key, mergedEntry] : top) {
+            topJson.push_back({{"key", key}, {"count", mergedEntry.count}, {"error", mergedEntry.error}});
+        }
+
+        return topJson;
+    }
+
+    nlohmann::json TrafficAnalytics::getTop(std::size_t n) {
+        advance();
+
+        return {{"window_seconds", getWindow().count()},
+                {"topics", {{"messages", getTop(TopicMessages, n)}, {"bytes", getTop(TopicBytes, n)}}},
+                {"prefixes", {{"messages", getTop(PrefixMessages, n)}, {"bytes", getTop(PrefixBytes, n)}}},
+                {"clients", {{"messages", getTop(ClientMessages, n)}, {"bytes", getTop(ClientBytes, n)}}}};
+    }
+
+    std::chrono::seconds TrafficAnalytics::getWindow() const {
+        return slotDuration * static_cast<std::chrono::seconds::rep>(slots.size());
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,127 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_TRAFFICANALYTICS_H
+#define MQTTBROKER_LIB_TRAFFICANALYTICS_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    // Space-Saving heavy hitter summary with a fixed number of counters. Counters live in a min-heap so that incrementing and replacing
+    // the smallest counter are O(log capacity). A reported count overestimates the true count by at most its error.
+    class SpaceSaving {
+    public:
+        struct Entry {
+            std::string key;
+            std::uint64_t count;
+            std::uint64_t error;
+        };
+
+        explicit SpaceSaving(std::size_t capacity);
+
+        void add(const std::string& key, std::uint64_t weight);
+        void clear();
+
+        const std::vector<Entry>& getEntries() const;
+        bool contains(const std::string& key) const;
+        bool full() const;
+        std::uint64_t minCount() const; // Upper bound of the count of every key not tracked
+
+    private:
+        void siftDown(std::size_t position);
+        void swapEntries(std::size_t a, std::size_t b);
+
+        std::size_t capacity;
+        std::vector<Entry> heap;
+        std::unordered_map<std::string, std::size_t> positions;
+    };
+
+    // Messages and bytes per topic, topic prefix and client id over a sliding window made of slots. Memory is bounded by
+    // slots * 6 * capacity counters, independent of the topic cardinality.
+    class TrafficAnalytics {
+    public:
+        TrafficAnalytics(std::size_t capacity = 256,
+                         std::size_t prefixDepth = 2,
+                         std::chrono::seconds slotDuration = std::chrono::seconds(10),
+                         std::size_t slotCount = 6);
+
+        void count(const std::string& clientId, const std::string& topic, std::size_t bytes);
+
+        nlohmann::json getTop(std::size_t n);
+
+        std::chrono::seconds getWindow() const;
+
+    private:
+        enum Sketch : std::size_t { TopicMessages, TopicBytes, PrefixMessages, PrefixBytes, ClientMessages, ClientBytes, SketchCount };
+
+        struct Slot {
+            explicit Slot(std::size_t capacity);
+
+            std::vector<SpaceSaving> sketches;
+        };
+
+        void advance();
+        nlohmann::json getTop(Sketch sketch, std::size_t n) const;
+
+        std::size_t prefixDepth;
+        std::chrono::seconds slotDuration;
+
+        std::vector<Slot> slots;
+        std::uint64_t currentSlotNumber = 0;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_TRAFFICANALYTICS_H
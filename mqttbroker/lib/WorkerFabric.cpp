@@ -0,0 +1,532 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "WorkerFabric.h"
+
+#include "MqttModel.h"
+#include "TopicFilter.h"
+
+#include <core/socket/State.h>
+#include <iot/mqtt/server/broker/Broker.h>
+#include <net/un/stream/legacy/SocketClient.h>
+#include <net/un/stream/legacy/SocketServer.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <csignal>
+#include <cstdlib>
+#include <log/Logger.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+namespace mqtt::mqttbroker::lib {
+
+    static void appendUint32(std::string& buffer, std::size_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    static uint32_t readUint32(std::string_view buffer, std::size_t position) {
+        uint32_t value = 0;
+
+        for (std::size_t i = 0; i < 4; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(buffer[position + i]);
+        }
+
+        return value;
+    }
+
+    static bool readString(std::string_view body, std::size_t& position, std::string& value) {
+        bool success = body.size() - position >= 4;
+
+        if (success) {
+            const std::size_t length = readUint32(body, position);
+            position += 4;
+
+            success = body.size() - position >= length;
+            if (success) {
+                value = body.substr(position, length);
+                position += length;
+            }
+        }
+
+        return success;
+    }
+
+    WorkerFabricSocketContext::WorkerFabricSocketContext(core::socket::stream::SocketConnection* socketConnection,
+                                                         WorkerFabric* workerFabric)
+        : core::socket::stream::SocketContext(socketConnection)
+        , workerFabric(workerFabric) {
+    }
+
+    void WorkerFabricSocketContext::sendFrame(const std::string& frame) const {
+        sendToPeer(frame.data(), frame.size());
+    }
+
+    std::size_t WorkerFabricSocketContext::getPeerIndex() const {
+        return peerIndex;
+    }
+
+    void WorkerFabricSocketContext::setPeerIndex(std::size_t peerIndex) {
+        this->peerIndex = peerIndex;
+    }
+
+    void WorkerFabricSocketContext::onConnected() {
+        workerFabric->onLinkConnected(this);
+    }
+
+    void WorkerFabricSocketContext::onDisconnected() {
+        workerFabric->onLinkDisconnected(this);
+    }
+
+    bool WorkerFabricSocketContext::onSignal([[maybe_unused]] int signum) {
+        return true;
+    }
+
+    std::size_t WorkerFabricSocketContext::onReceivedFromPeer() {
+        char chunk[16384];
+
+        const std::size_t chunkLen = readFromPeer(chunk, sizeof(chunk));
+        receiveBuffer.append(chunk, chunkLen);
+
+        std::size_t position = 0;
+        while (receiveBuffer.size() - position >= 4) {
+            const std::size_t frameLength = readUint32(receiveBuffer, position);
+
+            WorkerFabric::Frame frame;
+            if (frameLength > WorkerFabric::maxFrameSize) {
+                VLOG(0) << "Worker fabric: Frame of " << frameLength << " bytes too large. Closing link";
+                close();
+                break;
+            }
+            if (receiveBuffer.size() - position - 4 < frameLength) {
+                break;
+            }
+            if (!WorkerFabric::decodeFrame(std::string_view(receiveBuffer).substr(position + 4, frameLength), frame)) {
+                VLOG(0) << "Worker fabric: Malformed frame. Closing link";
+                close();
+                break;
+            }
+
+            workerFabric->onFrame(this, frame);
+
+            position += 4 + frameLength;
+        }
+        receiveBuffer.erase(0, position);
+
+        return chunkLen;
+    }
+
+    WorkerFabricSocketContextFactory::WorkerFabricSocketContextFactory(WorkerFabric* workerFabric)
+        : workerFabric(workerFabric) {
+    }
+
+    core::socket::stream::SocketContext*
+    WorkerFabricSocketContextFactory::create(core::socket::stream::SocketConnection* socketConnection) {
+        return new WorkerFabricSocketContext(socketConnection, workerFabric);
+    }
+
+    WorkerFabric& WorkerFabric::instance() {
+        static WorkerFabric workerFabric;
+
+        return workerFabric;
+    }
+
+    std::size_t WorkerFabric::getWorkerIndex() {
+        const char* worker = std::getenv("MQTTSUITE_BROKER_WORKER");
+
+        return worker != nullptr ? std::strtoul(worker, nullptr, 10) : 0;
+    }
+
+    std::string WorkerFabric::getFabricPath() {
+        const char* fabricPath = std::getenv("MQTTSUITE_BROKER_FABRIC");
+
+        return fabricPath != nullptr ? fabricPath : "/tmp/mqttbroker-fabric-" + std::to_string(getpid());
+    }
+
+    // The workers are fresh executions of the same binary with the same arguments, thus they parse the same configuration. They learn
+    // their index and the hub socket from the environment and terminate together with the hub
+    void WorkerFabric::spawnWorkers(char* argv[], std::size_t workerCount) {
+        const pid_t hubPid = getpid();
+
+        setenv("MQTTSUITE_BROKER_FABRIC", getFabricPath().c_str(), 1);
+        std::signal(SIGCHLD, SIG_IGN); // Exited workers are reaped automatically
+
+        for (std::size_t worker = 1; worker < workerCount; ++worker) {
+            const pid_t pid = fork();
+
+            if (pid == 0) {
+                prctl(PR_SET_PDEATHSIG, SIGTERM);
+                if (getppid() != hubPid) {
+                    _exit(EXIT_FAILURE);
+                }
+
+                setenv("MQTTSUITE_BROKER_WORKER", std::to_string(worker).c_str(), 1);
+                execv("/proc/self/exe", argv);
+
+                _exit(EXIT_FAILURE);
+            } else if (pid < 0) {
+                VLOG(0) << "Worker fabric: Spawning worker " << worker << " failed";
+            } else {
+                VLOG(1) << "Worker fabric: Worker " << worker << " has pid " << pid;
+            }
+        }
+    }
+
+    void WorkerFabric::start(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker,
+                             std::size_t workerIndex,
+                             std::size_t workerCount) {
+        workerMode = true;
+
+        open(broker, workerIndex, workerCount, getFabricPath());
+    }
+
+    void WorkerFabric::startHandoffHub(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker, const std::string& fabricPath) {
+        open(broker, 0, 2, fabricPath);
+    }
+
+    // The predecessor leaves the fabric by stopping, thus its link is not reconnected
+    void WorkerFabric::joinSuccessor(const std::string& fabricPath) {
+        handingOver = true;
+
+        open(broker, 1, 2, fabricPath);
+    }
+
+    void WorkerFabric::open(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker,
+                            std::size_t workerIndex,
+                            std::size_t workerCount,
+                            const std::string& fabricPath) {
+        this->broker = broker;
+        this->workerIndex = workerIndex;
+        this->workerCount = workerCount;
+
+        hubLink = nullptr;
+        workerLinks.assign(workerIndex == 0 ? workerCount : 0, nullptr);
+        remoteFilters.assign(workerCount, {});
+
+        // Subscriptions which did not pass through subscribe(), e.g. made before the fabric started, are announced as well
+        localFilters.clear();
+        for (const auto& [topicFilter, clients] : broker->getSubscriptionTree()) {
+            for (const auto& [clientId, qoS] : clients) {
+                subscribe(clientId, topicFilter);
+            }
+        }
+
+        if (workerIndex == 0) {
+            net::un::stream::legacy::Server<WorkerFabricSocketContextFactory>(
+                "fabric",
+                [fabricPath](net::un::stream::legacy::config::ConfigSocketServer* config) {
+                    config->setSunPath(fabricPath);
+                    config->setRetry();
+                },
+                this)
+                .listen([](const auto& socketAddress, const core::socket::State& state) {
+                    VLOG(1) << "Worker fabric hub: " << socketAddress.toString() << ": " << state.what();
+                });
+        } else {
+            net::un::stream::legacy::Client<WorkerFabricSocketContextFactory>(
+                handingOver ? "fabric-successor" : "fabric",
+                [fabricPath, reconnect = !handingOver](net::un::stream::legacy::config::ConfigSocketClient* config) {
+                    config->Remote::setSunPath(fabricPath);
+                    config->setRetry();
+                    config->setRetryBase(1);
+                    if (reconnect) {
+                        config->setReconnect();
+                    }
+                },
+                this)
+                .connect([workerIndex](const auto& socketAddress, const core::socket::State& state) {
+                    VLOG(1) << "Worker fabric worker " << workerIndex << ": " << socketAddress.toString() << ": " << state.what();
+                });
+        }
+    }
+
+    bool WorkerFabric::isActive() const {
+        return workerCount > 1;
+    }
+
+    bool WorkerFabric::isWorkerMode() const {
+        return workerMode;
+    }
+
+    bool WorkerFabric::isLinkedToHub() const {
+        return hubLink != nullptr;
+    }
+
+    void WorkerFabric::forwardPublish(const std::string& topic, const std::string& message, uint8_t qoS, bool retain) {
+        if (isActive()) {
+            const Frame frame{Publish, static_cast<uint32_t>(workerIndex), topic, message, qoS, retain};
+
+            if (workerIndex == 0) {
+                relay(frame);
+            } else if (hubLink != nullptr) {
+                bool forward = retain;
+                for (std::size_t worker = 0; worker < workerCount && !forward; ++worker) {
+                    forward = worker != workerIndex && isInterested(worker, topic);
+                }
+
+                if (forward) {
+                    hubLink->sendFrame(encodeFrame(frame));
+                }
+            }
+        }
+    }
+
+    // A shared subscription "$share/<group>/<filter>" makes the worker interested in <filter>. The interest is kept per subscription
+    // "<client id>\0<topic filter>" because a client may subscribe to a filter both directly and shared
+    void WorkerFabric::subscribe(const std::string& clientId, const std::string& topicFilter) {
+        if (isActive()) {
+            std::string group;
+            std::string filter = topicFilter;
+            parseSharedSubscription(topicFilter, group, filter);
+
+            std::set<std::string>& subscriptions = localFilters[filter];
+
+            if (subscriptions.insert(clientId + '\0' + topicFilter).second && subscriptions.size() == 1) {
+                announce(Subscribe, filter);
+            }
+        }
+    }
+
+    // Subscriptions dropped with a clean session are not announced. The other workers then forward a few publishes too many, which
+    // the local broker drops for lack of subscribers
+    void WorkerFabric::unsubscribe(const std::string& clientId, const std::string& topicFilter) {
+        if (isActive()) {
+            std::string group;
+            std::string filter = topicFilter;
+            parseSharedSubscription(topicFilter, group, filter);
+
+            auto localFilterIt = localFilters.find(filter);
+
+            if (localFilterIt != localFilters.end() && localFilterIt->second.erase(clientId + '\0' + topicFilter) > 0 &&
+                localFilterIt->second.empty()) {
+                localFilters.erase(localFilterIt);
+
+                announce(Unsubscribe, filter);
+            }
+        }
+    }
+
+    std::string WorkerFabric::encodeFrame(const Frame& frame) {
+        std::string body;
+        body.reserve(1 + 4 + 4 + frame.topic.size() + 4 + frame.message.size() + 2);
+
+        body.push_back(frame.type);
+        appendUint32(body, frame.worker);
+        appendUint32(body, frame.topic.size());
+        body += frame.topic;
+        appendUint32(body, frame.message.size());
+        body += frame.message;
+        body.push_back(static_cast<char>(frame.qoS));
+        body.push_back(frame.retain ? 1 : 0);
+
+        std::string encodedFrame;
+        encodedFrame.reserve(4 + body.size());
+        appendUint32(encodedFrame, body.size());
+
+        return encodedFrame + body;
+    }
+
+    bool WorkerFabric::decodeFrame(std::string_view body, Frame& frame) {
+        bool success = body.size() >= 5;
+
+        if (success) {
+            frame.type = static_cast<FrameType>(body[0]);
+            frame.worker = readUint32(body, 1);
+
+            std::size_t position = 5;
+            success = readString(body, position, frame.topic) && readString(body, position, frame.message) && body.size() - position == 2;
+
+            if (success) {
+                frame.qoS = static_cast<uint8_t>(body[position]);
+                frame.retain = body[position + 1] != 0;
+            }
+        }
+
+        return success;
+    }
+
+    void WorkerFabric::onLinkConnected(WorkerFabricSocketContext* link) {
+        if (workerIndex != 0) {
+            hubLink = link;
+
+            link->sendFrame(encodeFrame({Hello, static_cast<uint32_t>(workerIndex), "", "", 0, false}));
+            for (const auto& [topicFilter, clientIds] : localFilters) {
+                link->sendFrame(encodeFrame({Subscribe, static_cast<uint32_t>(workerIndex), topicFilter, "", 0, false}));
+            }
+
+            // The $-topics, e.g. the $SYS/broker statistics, are owned by each broker itself
+            if (handingOver) {
+                for (const auto& [topic, retained] : broker->getRetainTree()) {
+                    if (!topic.starts_with('$')) {
+                        link->sendFrame(
+                            encodeFrame({Publish, static_cast<uint32_t>(workerIndex), topic, retained.first, retained.second, true}));
+                    }
+                }
+            }
+        }
+    }
+
+    void WorkerFabric::onLinkDisconnected(WorkerFabricSocketContext* link) {
+        if (workerIndex == 0) {
+            const std::size_t worker = link->getPeerIndex();
+
+            if (worker > 0 && workerLinks[worker] == link) {
+                workerLinks[worker] = nullptr;
+
+                for (const std::string& topicFilter : remoteFilters[worker]) {
+                    relay({Unsubscribe, static_cast<uint32_t>(worker), topicFilter, "", 0, false});
+                }
+                remoteFilters[worker].clear();
+
+                VLOG(1) << "Worker fabric: Worker " << worker << " left";
+            }
+        } else if (hubLink == link) {
+            hubLink = nullptr;
+
+            // The hub resends all filters when the link is back
+            for (std::set<std::string>& topicFilters : remoteFilters) {
+                topicFilters.clear();
+            }
+        }
+    }
+
+    void WorkerFabric::onFrame(WorkerFabricSocketContext* link, const Frame& frame) {
+        if (frame.worker >= workerCount) {
+            VLOG(0) << "Worker fabric: Frame from unknown worker " << frame.worker;
+        } else if (frame.type == Hello && workerIndex == 0 && frame.worker > 0) {
+            link->setPeerIndex(frame.worker);
+            workerLinks[frame.worker] = link;
+
+            for (std::size_t worker = 0; worker < workerCount; ++worker) {
+                if (worker == 0) {
+                    for (const auto& [topicFilter, clientIds] : localFilters) {
+                        link->sendFrame(encodeFrame({Subscribe, 0, topicFilter, "", 0, false}));
+                    }
+                } else if (worker != frame.worker) {
+                    for (const std::string& topicFilter : remoteFilters[worker]) {
+                        link->sendFrame(encodeFrame({Subscribe, static_cast<uint32_t>(worker), topicFilter, "", 0, false}));
+                    }
+                }
+            }
+
+            if (workerMode) {
+                for (const auto& [topic, retained] : broker->getRetainTree()) {
+                    link->sendFrame(encodeFrame({Publish, 0, topic, retained.first, retained.second, true}));
+                }
+            }
+
+            VLOG(1) << "Worker fabric: Worker " << frame.worker << " joined";
+        } else if (frame.type == Subscribe || frame.type == Unsubscribe) {
+            if (frame.type == Subscribe) {
+                remoteFilters[frame.worker].insert(frame.topic);
+            } else {
+                remoteFilters[frame.worker].erase(frame.topic);
+            }
+
+            if (workerIndex == 0) {
+                relay(frame);
+            }
+        } else if (frame.type == Publish) {
+            if (workerIndex != 0 || frame.retain || isInterested(workerIndex, frame.topic)) {
+                deliver(frame);
+            }
+
+            if (workerIndex == 0) {
+                relay(frame);
+            }
+        }
+    }
+
+    void WorkerFabric::announce(FrameType type, const std::string& topicFilter) {
+        const Frame frame{type, static_cast<uint32_t>(workerIndex), topicFilter, "", 0, false};
+
+        if (workerIndex == 0) {
+            relay(frame);
+        } else if (hubLink != nullptr) {
+            hubLink->sendFrame(encodeFrame(frame));
+        }
+    }
+
+    // Hub only: sends a frame to every connected worker except its origin. Publishes only to the interested ones
+    void WorkerFabric::relay(const Frame& frame) {
+        std::string frameToSend;
+
+        for (std::size_t worker = 1; worker < workerCount; ++worker) {
+            if (worker != frame.worker && workerLinks[worker] != nullptr &&
+                (frame.type != Publish || frame.retain || isInterested(worker, frame.topic))) {
+                if (frameToSend.empty()) {
+                    frameToSend = encodeFrame(frame);
+                }
+
+                workerLinks[worker]->sendFrame(frameToSend);
+            }
+        }
+    }
+
+    void WorkerFabric::deliver(const Frame& frame) {
+        broker->publish("", frame.topic, frame.message, frame.qoS, frame.retain);
+
+        MqttModel::instance().publishMessage(frame.topic, frame.message, frame.qoS, frame.retain);
+    }
+
+    bool WorkerFabric::isInterested(std::size_t worker, const std::string& topic) const {
+        bool interested = false;
+
+        if (worker == workerIndex) {
+            for (auto localFilterIt = localFilters.begin(); localFilterIt != localFilters.end() && !interested; ++localFilterIt) {
+                interested = topicFilterMatches(localFilterIt->first, topic);
+            }
+        } else {
+            for (auto remoteFilterIt = remoteFilters[worker].begin(); remoteFilterIt != remoteFilters[worker].end() && !interested;
+                 ++remoteFilterIt) {
+                interested = topicFilterMatches(*remoteFilterIt, topic);
+            }
+        }
+
+        return interested;
+    }
+
+} // namespace mqtt::mqttbroker::lib
@@ -0,0 +1,191 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTBROKER_LIB_WORKERFABRIC_H
+#define MQTTBROKER_LIB_WORKERFABRIC_H
+
+#include <core/socket/stream/SocketContext.h>
+#include <core/socket/stream/SocketContextFactory.h>
+
+namespace iot::mqtt::server::broker {
+    class Broker;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttbroker::lib {
+
+    class WorkerFabric;
+
+    // One end of a fabric link. Frames are length prefixed and may arrive split over several reads
+    class WorkerFabricSocketContext : public core::socket::stream::SocketContext {
+    public:
+        WorkerFabricSocketContext(core::socket::stream::SocketConnection* socketConnection, WorkerFabric* workerFabric);
+
+        void sendFrame(const std::string& frame) const;
+
+        std::size_t getPeerIndex() const;
+        void setPeerIndex(std::size_t peerIndex);
+
+    private:
+        void onConnected() final;
+        void onDisconnected() final;
+        bool onSignal(int signum) final;
+        std::size_t onReceivedFromPeer() final;
+
+        WorkerFabric* workerFabric;
+        std::string receiveBuffer;
+        std::size_t peerIndex = 0;
+    };
+
+    class WorkerFabricSocketContextFactory : public core::socket::stream::SocketContextFactory {
+    public:
+        explicit WorkerFabricSocketContextFactory(WorkerFabric* workerFabric);
+
+    private:
+        core::socket::stream::SocketContext* create(core::socket::stream::SocketConnection* socketConnection) final;
+
+        WorkerFabric* workerFabric;
+    };
+
+    // Couples the broker processes of the worker mode to one logical broker. Worker 0 is the hub: every other worker connects to it via
+    // a unix domain socket and the hub relays between them. Each worker announces the topic filters its clients subscribed to, so
+    // every worker knows the interest of all others and forwards a publish only to the workers having a matching filter. Retained
+    // publishes go to all workers, and a worker joining the fabric first gets the retained messages of the hub.
+    //
+    // Known limits: A client is served by the worker its connection was routed to by SO_REUSEPORT, there is no owner per client id.
+    // Thus persistent sessions are rejected and no session store is used, and the same client id may be connected to two workers at
+    // once. $SYS topics and mapping aggregates are per worker.
+    //
+    // A listener handoff couples the draining and the new broker the same way: each broker with a handoff socket is the hub of a
+    // fabric of two and its predecessor joins as worker 1. Unlike a freshly spawned worker the predecessor brings its retained
+    // messages along instead of receiving those of the hub.
+    class WorkerFabric {
+    private:
+        WorkerFabric() = default;
+
+    public:
+        WorkerFabric(const WorkerFabric&) = delete;
+        WorkerFabric& operator=(const WorkerFabric&) = delete;
+
+        static WorkerFabric& instance();
+
+        static std::size_t getWorkerIndex(); // 0 for the process started by the user
+        static void spawnWorkers(char* argv[], std::size_t workerCount);
+
+        void start(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker, std::size_t workerIndex, std::size_t workerCount);
+
+        void startHandoffHub(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker, const std::string& fabricPath);
+        void joinSuccessor(const std::string& fabricPath); // Switches from hub to worker 1 of the fabric of the successor
+
+        bool isActive() const;
+        bool isWorkerMode() const;
+        bool isLinkedToHub() const;
+
+        // Called for every publish entering the local broker, not for those delivered from the fabric
+        void forwardPublish(const std::string& topic, const std::string& message, uint8_t qoS, bool retain);
+
+        void subscribe(const std::string& clientId, const std::string& topicFilter);
+        void unsubscribe(const std::string& clientId, const std::string& topicFilter);
+
+    private:
+        friend class WorkerFabricSocketContext;
+
+        enum FrameType : char { Hello = 'H', Subscribe = 'S', Unsubscribe = 'U', Publish = 'P' };
+
+        struct Frame {
+            FrameType type;
+            uint32_t worker; // The announcing or originating worker
+            std::string topic;
+            std::string message;
+            uint8_t qoS = 0;
+            bool retain = false;
+        };
+
+        void open(const std::shared_ptr<iot::mqtt::server::broker::Broker>& broker,
+                  std::size_t workerIndex,
+                  std::size_t workerCount,
+                  const std::string& fabricPath);
+
+        static std::string encodeFrame(const Frame& frame);
+        static bool decodeFrame(std::string_view body, Frame& frame);
+
+        void onLinkConnected(WorkerFabricSocketContext* link);
+        void onLinkDisconnected(WorkerFabricSocketContext* link);
+        void onFrame(WorkerFabricSocketContext* link, const Frame& frame);
+
+        void announce(FrameType type, const std::string& topicFilter);
+        void relay(const Frame& frame);
+        void deliver(const Frame& frame);
+        bool isInterested(std::size_t worker, const std::string& topic) const;
+
+        static std::string getFabricPath();
+
+        std::shared_ptr<iot::mqtt::server::broker::Broker> broker;
+        std::size_t workerIndex = 0;
+        std::size_t workerCount = 1;
+        bool workerMode = false;
+        bool handingOver = false;
+
+        std::map<std::string, std::set<std::string>> localFilters; // Topic filter -> subscriptions
+        std::vector<std::set<std::string>> remoteFilters;           // Per worker
+
+        WorkerFabricSocketContext* hubLink = nullptr;           // On the workers
+        std::vector<WorkerFabricSocketContext*> workerLinks; // On the hub, per worker
+
+        static constexpr std::size_t maxFrameSize = 256 * 1024 * 1024;
+    };
+
+} // namespace mqtt::mqttbroker::lib
+
+#endif // MQTTBROKER_LIB_WORKERFABRIC_H
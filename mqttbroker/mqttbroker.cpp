@@ -42,12 +42,21 @@
 #include "SocketContextFactory.h" // IWYU pragma: keep
 #include "config.h"
 #include "lib/ConfigApplication.h"
+#include "lib/ListenerHandoff.h"
+#include "lib/Metrics.h"
 #include "lib/Mqtt.h"
+#include "lib/MqttMapper.h"
 #include "lib/MqttModel.h"
+#include "lib/RetainedStore.h"
+#include "lib/SysTopicPublisher.h"
+#include "lib/TopicFilter.h"
+#include "lib/WorkerFabric.h"
 
 #include <core/SNodeC.h>
 #include <utils/Config.h>
 //
+#include <express/Request.h>
+#include <express/Response.h>
 #include <express/middleware/JsonMiddleware.h>
 #include <express/middleware/StaticMiddleware.h>
 #include <iot/mqtt/MqttContext.h>
@@ -105,7 +114,12 @@
 //
 #include <log/Logger.h>
 //
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #endif
 
@@ -145,6 +159,82 @@ static void upgrade APPLICATION(req, res) {
     }
 }
 
+// Topic filter and cursor helpers for the paginated /api/mqtt/retained and /api/mqtt/subscriptions snapshots
+
+// Cursors are the hex encoded key of the last returned entry, thus opaque and URL safe
+static std::string encodeCursor(const std::string& key) {
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    std::string cursor;
+    cursor.reserve(key.size() * 2);
+    for (const char c : key) {
+        cursor += hexDigits[static_cast<unsigned char>(c) >> 4];
+        cursor += hexDigits[static_cast<unsigned char>(c) & 0x0f];
+    }
+
+    return cursor;
+}
+
+static bool decodeCursor(const std::string& cursor, std::string& key) {
+    key.clear();
+
+    bool success = cursor.size() % 2 == 0;
+    for (std::size_t i = 0; success && i < cursor.size(); i += 2) {
+        try {
+            std::size_t processed = 0;
+            key += static_cast<char>(std::stoi(cursor.substr(i, 2), &processed, 16));
+            success = processed == 2;
+        } catch (const std::exception&) {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+struct SnapshotQuery {
+    std::string filter; // Empty if none was given
+    std::string cursorKey;
+    std::size_t limit = 100;
+};
+
+static constexpr std::size_t maxSnapshotLimit = 1000;
+
+static bool parseSnapshotQuery(const std::shared_ptr<express::Request>& req,
+                               const std::shared_ptr<express::Response>& res,
+                               SnapshotQuery& snapshotQuery) {
+    snapshotQuery.filter = req->query("filter");
+    if (!snapshotQuery.filter.empty() && !mqtt::mqttbroker::lib::isValidTopicFilter(snapshotQuery.filter)) {
+        res->status(400).send(nlohmann::json({{"error", "Invalid topic filter"}, {"filter", snapshotQuery.filter}}).dump());
+        return false;
+    }
+
+    if (!decodeCursor(req->query("cursor"), snapshotQuery.cursorKey)) {
+        res->status(400).send(nlohmann::json({{"error", "Invalid cursor"}}).dump());
+        return false;
+    }
+
+    if (!req->query("limit").empty()) {
+        try {
+            snapshotQuery.limit = std::clamp<std::size_t>(std::stoul(req->query("limit")), 1, maxSnapshotLimit);
+        } catch (const std::exception&) {
+            res->status(400).send(nlohmann::json({{"error", "Invalid limit"}}).dump());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Appends the items directly to the body instead of building a JSON array of the whole page first
+static void sendSnapshotPage(const std::shared_ptr<express::Response>& res, const std::string& items, const std::string& nextCursorKey) {
+    std::string body = "{\"items\":[" + items + "],\"next_cursor\":";
+    body += nextCursorKey.empty() ? "null" : "\"" + encodeCursor(nextCursorKey) + "\"";
+    body += "}";
+
+    res->set("Content-Type", "application/json").send(body);
+}
+
 static express::Router getRouter(std::shared_ptr<iot::mqtt::server::broker::Broker> broker, const std::string& webRoot) {
     const express::Router& jsonRouter = express::middleware::JsonMiddleware();
 
@@ -278,6 +368,149 @@ static express::Router getRouter(std::shared_ptr<iot::mqtt::server::broker::Brok
                 res->status(400).send("Attribute type not found: " + key);
             });
     });
+    /*
+     * /api/mqtt/mapping-cache
+     */
+    jsonRouter.get("/api/mqtt/mapping-cache", [] APPLICATION(req, res) {
+        const mqtt::lib::MqttMapper::RenderCacheStatistics statistics =
+            utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper()->getRenderCacheStatistics();
+        const uint64_t lookups = statistics.hits + statistics.misses;
+
+        res->send(nlohmann::json({{"capacity", statistics.capacity},
+                                  {"entries", statistics.entries},
+                                  {"hits", statistics.hits},
+                                  {"misses", statistics.misses},
+                                  {"bypasses", statistics.bypasses},
+                                  {"hit_rate", lookups > 0 ? static_cast<double>(statistics.hits) / static_cast<double>(lookups) : 0.0}})
+                      .dump());
+    });
+
+    /*
+     * /api/mqtt/mapping-chain
+     */
+    jsonRouter.get("/api/mqtt/mapping-chain", [] APPLICATION(req, res) {
+        const mqtt::mqttbroker::lib::Mqtt::MappingChainStatistics& statistics =
+            mqtt::mqttbroker::lib::Mqtt::getMappingChainStatistics();
+
+        const std::size_t maxDepth = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMappingMaxChainDepth();
+
+        res->send(nlohmann::json({{"max_depth", maxDepth},
+                                  {"chains", statistics.chains},
+                                  {"mapped_publishes", statistics.mappedPublishes},
+                                  {"dropped_cycles", statistics.droppedCycles},
+                                  {"dropped_too_deep", statistics.droppedTooDeep},
+                                  {"max_depth_seen", statistics.maxDepthSeen}})
+                      .dump());
+    });
+
+    /*
+     * /api/mqtt/traffic-top?n=10
+     */
+    jsonRouter.get("/api/mqtt/traffic-top", [] APPLICATION(req, res) {
+        std::size_t n = 10;
+
+        if (!req->query("n").empty()) {
+            try {
+                n = std::clamp<std::size_t>(std::stoul(req->query("n")), 1, maxSnapshotLimit);
+            } catch (const std::exception&) {
+                res->status(400).send(nlohmann::json({{"error", "Invalid n"}}).dump());
+                return;
+            }
+        }
+
+        res->send(mqtt::mqttbroker::lib::MqttModel::instance().getTrafficTop(n).dump());
+    });
+
+    /*
+     * /api/mqtt/retained?filter=a/+/#&cursor=...&limit=...
+     * Without filter "#" applies, which like any wildcard on the first level does not match $-topics
+     */
+    jsonRouter.get("/api/mqtt/retained", [broker] APPLICATION(req, res) {
+        SnapshotQuery snapshotQuery;
+
+        if (parseSnapshotQuery(req, res, snapshotQuery)) {
+            const std::string_view filter = snapshotQuery.filter.empty() ? std::string_view("#") : snapshotQuery.filter;
+            const auto retainTree = broker->getRetainTree();
+
+            std::string items;
+            std::string nextCursorKey;
+            std::size_t count = 0;
+            bool more = false;
+
+            for (auto it = snapshotQuery.cursorKey.empty() ? retainTree.begin() : retainTree.upper_bound(snapshotQuery.cursorKey);
+                 it != retainTree.end() && !more;
+                 ++it) {
+                if (!mqtt::mqttbroker::lib::topicFilterMatches(filter, it->first)) {
+                    continue;
+                }
+                if (count == snapshotQuery.limit) {
+                    more = true;
+                    break;
+                }
+                if (count++ > 0) {
+                    items += ',';
+                }
+                items += nlohmann::json({{"topic", it->first}, {"message", it->second.first}, {"qos", it->second.second}}).dump();
+
+                nextCursorKey = it->first;
+            }
+
+            sendSnapshotPage(res, items, more ? nextCursorKey : "");
+        }
+    });
+
+    /*
+     * /api/mqtt/subscriptions?filter=a/+/#&clientId=...&cursor=...&limit=...
+     * The filter is matched against the subscribed topic filters, wildcards in them are compared literally. Without filter all
+     * subscriptions are listed, $-prefixed ones included
+     */
+    jsonRouter.get("/api/mqtt/subscriptions", [broker] APPLICATION(req, res) {
+        SnapshotQuery snapshotQuery;
+
+        if (parseSnapshotQuery(req, res, snapshotQuery)) {
+            const std::string& clientIdFilter = req->query("clientId");
+            const auto subscriptionTree = broker->getSubscriptionTree();
+
+            // Cursor key is "<topic>\0<clientId>"
+            const std::string::size_type separator = snapshotQuery.cursorKey.find('\0');
+            const std::string cursorTopic = snapshotQuery.cursorKey.substr(0, separator);
+            const std::string cursorClientId = separator != std::string::npos ? snapshotQuery.cursorKey.substr(separator + 1) : "";
+
+            std::string items;
+            std::string nextCursorKey;
+            std::size_t count = 0;
+            bool more = false;
+
+            for (auto it = subscriptionTree.lower_bound(cursorTopic); it != subscriptionTree.end() && !more; ++it) {
+                if (!snapshotQuery.filter.empty() && !mqtt::mqttbroker::lib::topicFilterMatches(snapshotQuery.filter, it->first)) {
+                    continue;
+                }
+
+                std::vector<std::pair<std::string, uint8_t>> clients(it->second.begin(), it->second.end());
+                std::sort(clients.begin(), clients.end());
+
+                for (const auto& [clientId, qoS] : clients) {
+                    if ((!snapshotQuery.cursorKey.empty() && it->first == cursorTopic && clientId <= cursorClientId) ||
+                        (!clientIdFilter.empty() && clientId != clientIdFilter)) {
+                        continue;
+                    }
+                    if (count == snapshotQuery.limit) {
+                        more = true;
+                        break;
+                    }
+                    if (count++ > 0) {
+                        items += ',';
+                    }
+                    items += nlohmann::json({{"topic", it->first}, {"clientId", clientId}, {"qos", qoS}}).dump();
+
+                    nextCursorKey = it->first + '\0' + clientId;
+                }
+            }
+
+            sendSnapshotPage(res, items, more ? nextCursorKey : "");
+        }
+    });
+
     const express::Router router;
 
     router.use(jsonRouter);
@@ -334,6 +567,11 @@ static express::Router getRouter(std::shared_ptr<iot::mqtt::server::broker::Brok
         }
     });
 
+    router.get("/metrics", [] APPLICATION(req, res) {
+        res->set("Content-Type", mqtt::lib::metrics::Registry::contentType);
+        res->send(mqtt::lib::metrics::Registry::instance().renderPrometheus());
+    });
+
     router.get("/clients", [] APPLICATION(req, res) {
         res->redirect("/clients/index.html");
     });
@@ -371,16 +609,91 @@ int main(int argc, char* argv[]) {
 
     core::SNodeC::init(argc, argv);
 
-    std::shared_ptr<iot::mqtt::server::broker::Broker> broker = iot::mqtt::server::broker::Broker::instance(
-        SUBSCRIPTION_MAX_QOS, utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getSessionStore());
+    // Worker mode: the primary (worker 0) spawns the other workers, all accept on the same MQTT ports via SO_REUSEPORT and the
+    // worker fabric couples them to one logical broker. Only the primary serves HTTP and the unix domain sockets. No worker persists
+    // sessions, as a client may reconnect to any of them
+    const std::size_t workers = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getWorkers();
+    const std::size_t workerIndex = mqtt::mqttbroker::lib::WorkerFabric::getWorkerIndex();
+    const bool primary = workerIndex == 0;
+
+    if (primary && workers > 1) {
+        mqtt::mqttbroker::lib::WorkerFabric::spawnWorkers(argv, workers);
+    }
+
+    std::string sessionStore = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getSessionStore();
+    if (workers > 1 && !sessionStore.empty()) {
+        if (primary) {
+            VLOG(0) << "Session store '" << sessionStore << "' ignored: Persistent sessions are not supported in worker mode";
+        }
+        sessionStore.clear();
+    }
+
+    std::shared_ptr<iot::mqtt::server::broker::Broker> broker =
+        iot::mqtt::server::broker::Broker::instance(SUBSCRIPTION_MAX_QOS, sessionStore);
+
+    mqtt::mqttbroker::lib::MqttModel::instance().setSharedSubscriptionStrategy(
+        utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getSharedSubscriptionStrategy() == "sticky"
+            ? mqtt::mqttbroker::lib::SharedSubscriptions::Strategy::Sticky
+            : mqtt::mqttbroker::lib::SharedSubscriptions::Strategy::RoundRobin);
+    mqtt::mqttbroker::lib::MqttModel::instance().restoreSharedSubscriptions(broker);
+
+    // Restored before the workers join the fabric, they get the retained messages from the primary
+    std::unique_ptr<mqtt::mqttbroker::lib::RetainedStore> retainedStore;
+    if (const std::string retainedStorePath = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getRetainedStore();
+        primary && !retainedStorePath.empty()) {
+        retainedStore = std::make_unique<mqtt::mqttbroker::lib::RetainedStore>(retainedStorePath);
+        retainedStore->restore(broker);
+
+        mqtt::mqttbroker::lib::MqttModel::instance().setOnRetainChanged(
+            [retainedStore = retainedStore.get()](const std::string& topic, const std::string& message, uint8_t qoS) {
+                retainedStore->retain(topic, message, qoS);
+            });
+    }
+
+    if (workers > 1) {
+        mqtt::mqttbroker::lib::WorkerFabric::instance().start(broker, workerIndex, workers);
+    }
+
+    utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper()->setOnAggregate(
+        [broker](const iot::mqtt::packets::Publish& publish) {
+            broker->publish("", publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+            mqtt::mqttbroker::lib::MqttModel::instance().publishMessage(
+                publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+            mqtt::mqttbroker::lib::WorkerFabric::instance().forwardPublish(
+                publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+        });
+
+    std::unique_ptr<mqtt::mqttbroker::lib::SysTopicPublisher> sysTopicPublisher;
+    if (const std::size_t sysInterval = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getSysInterval();
+        sysInterval > 0) {
+        sysTopicPublisher = std::make_unique<mqtt::mqttbroker::lib::SysTopicPublisher>(broker, static_cast<double>(sysInterval));
+    }
+
+    // Upgrade: the successor binds the TCP ports alongside via SO_REUSEPORT and takes them over. Both brokers run at once while the
+    // predecessor drains, thus they must not share the session or retained store files
+    std::unique_ptr<mqtt::mqttbroker::lib::ListenerHandoff> listenerHandoff;
+    if (const std::string handoffSocket = utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getHandoffSocket();
+        !handoffSocket.empty()) {
+        if (workers > 1) {
+            VLOG(0) << "Listener handoff is not supported in worker mode";
+        } else if (!sessionStore.empty() || retainedStore != nullptr) {
+            VLOG(0) << "Listener handoff is not supported together with a session or retained store";
+        } else {
+            listenerHandoff = std::make_unique<mqtt::mqttbroker::lib::ListenerHandoff>(
+                handoffSocket, utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getHandoffDrainRate(), broker);
+        }
+    }
+
+    const bool reusePort = workers > 1 || listenerHandoff != nullptr;
 
 #ifdef CONFIG_MQTTSUITE_BROKER_TCP_IPV4
     net::in::stream::legacy::Server<mqtt::mqttbroker::SocketContextFactory>( //
         "in-mqtt",
-        [](net::in::stream::legacy::config::ConfigSocketServer* config) {
+        [reusePort](net::in::stream::legacy::config::ConfigSocketServer* config) {
             config->setPort(1883);
             config->setRetry();
             config->setDisableNagleAlgorithm();
+            config->setReusePort(reusePort);
         },
         broker)
         .listen([](const auto& socketAddress, core::socket::State state) {
@@ -390,10 +703,11 @@ int main(int argc, char* argv[]) {
 #ifdef CONFIG_MQTTSUITE_BROKER_TLS_IPV4
     net::in::stream::tls::Server<mqtt::mqttbroker::SocketContextFactory>( //
         "in-mqtts",
-        [](net::in::stream::tls::config::ConfigSocketServer* config) {
+        [reusePort](net::in::stream::tls::config::ConfigSocketServer* config) {
             config->setPort(8883);
             config->setRetry();
             config->setDisableNagleAlgorithm();
+            config->setReusePort(reusePort);
         },
         broker)
         .listen([](const auto& socketAddress, core::socket::State state) {
@@ -405,10 +719,11 @@ int main(int argc, char* argv[]) {
 #ifdef CONFIG_MQTTSUITE_BROKER_TCP_IPV6
     net::in6::stream::legacy::Server<mqtt::mqttbroker::SocketContextFactory>( //
         "in6-mqtt",
-        [](net::in6::stream::legacy::config::ConfigSocketServer* config) {
+        [reusePort](net::in6::stream::legacy::config::ConfigSocketServer* config) {
             config->setPort(1883);
             config->setRetry();
             config->setDisableNagleAlgorithm();
+            config->setReusePort(reusePort);
 
             config->setIPv6Only();
         },
@@ -420,10 +735,11 @@ int main(int argc, char* argv[]) {
 #ifdef CONFIG_MQTTSUITE_BROKER_TLS_IPV6
     net::in6::stream::tls::Server<mqtt::mqttbroker::SocketContextFactory>( //
         "in6-mqtts",
-        [](net::in6::stream::tls::config::ConfigSocketServer* config) {
+        [reusePort](net::in6::stream::tls::config::ConfigSocketServer* config) {
             config->setPort(8883);
             config->setRetry();
             config->setDisableNagleAlgorithm();
+            config->setReusePort(reusePort);
 
             config->setIPv6Only();
         },
@@ -434,104 +750,110 @@ int main(int argc, char* argv[]) {
 #endif
 #endif
 
+    if (primary) {
 #ifdef CONFIG_MQTTSUITE_BROKER_UNIX
-    net::un::stream::legacy::Server<mqtt::mqttbroker::SocketContextFactory>( //
-        "un-mqtt",
-        [](net::un::stream::legacy::config::ConfigSocketServer* config) {
-            config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
-            config->setRetry();
-        },
-        broker)
-        .listen([](const auto& socketAddress, core::socket::State state) {
-            reportState("un-mqtt", socketAddress, state);
-        });
+        net::un::stream::legacy::Server<mqtt::mqttbroker::SocketContextFactory>( //
+            "un-mqtt",
+            [](net::un::stream::legacy::config::ConfigSocketServer* config) {
+                config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
+                config->setRetry();
+            },
+            broker)
+            .listen([](const auto& socketAddress, core::socket::State state) {
+                reportState("un-mqtt", socketAddress, state);
+            });
 
 #ifdef CONFIG_MQTTSUITE_BROKER_UNIX_TLS
-    net::un::stream::tls::Server<mqtt::mqttbroker::SocketContextFactory>( //
-        "un-mqtts",
-        [](net::un::stream::tls::config::ConfigSocketServer* config) {
-            config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
-            config->setRetry();
-        },
-        broker)
-        .listen([](const auto& socketAddress, core::socket::State state) {
-            reportState("un-mqtts", socketAddress, state);
-        });
+        net::un::stream::tls::Server<mqtt::mqttbroker::SocketContextFactory>( //
+            "un-mqtts",
+            [](net::un::stream::tls::config::ConfigSocketServer* config) {
+                config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
+                config->setRetry();
+            },
+            broker)
+            .listen([](const auto& socketAddress, core::socket::State state) {
+                reportState("un-mqtts", socketAddress, state);
+            });
 #endif
 #endif
-    express::Router router = getRouter(broker, utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getHtmlRoot());
+        express::Router router = getRouter(broker, utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getHtmlRoot());
 
 #ifdef CONFIG_MQTTSUITE_BROKER_TCP_IPV4
-    express::legacy::in::Server( //
-        "in-http",
-        router,
-        reportState,
-        [](net::in::stream::legacy::config::ConfigSocketServer* config) {
-            config->setPort(8080);
-            config->setRetry();
-            config->setDisableNagleAlgorithm();
-        });
+        express::legacy::in::Server( //
+            "in-http",
+            router,
+            reportState,
+            [reusePort](net::in::stream::legacy::config::ConfigSocketServer* config) {
+                config->setPort(8080);
+                config->setRetry();
+                config->setDisableNagleAlgorithm();
+                config->setReusePort(reusePort);
+            });
 
 #ifdef CONFIG_MQTTSUITE_BROKER_TLS_IPV4
-    express::tls::in::Server( //
-        "in-https",
-        router,
-        reportState,
-        [](net::in::stream::tls::config::ConfigSocketServer* config) {
-            config->setPort(8088);
-            config->setRetry();
-            config->setDisableNagleAlgorithm();
-        });
+        express::tls::in::Server( //
+            "in-https",
+            router,
+            reportState,
+            [reusePort](net::in::stream::tls::config::ConfigSocketServer* config) {
+                config->setPort(8088);
+                config->setRetry();
+                config->setDisableNagleAlgorithm();
+                config->setReusePort(reusePort);
+            });
 #endif
 #endif
 
 #ifdef CONFIG_MQTTSUITE_BROKER_TCP_IPV6
-    express::legacy::in6::Server( //
-        "in6-http",
-        router,
-        reportState,
-        [](net::in6::stream::legacy::config::ConfigSocketServer* config) {
-            config->setPort(8080);
-            config->setRetry();
-            config->setDisableNagleAlgorithm();
-
-            config->setIPv6Only();
-        });
+        express::legacy::in6::Server( //
+            "in6-http",
+            router,
+            reportState,
+            [reusePort](net::in6::stream::legacy::config::ConfigSocketServer* config) {
+                config->setPort(8080);
+                config->setRetry();
+                config->setDisableNagleAlgorithm();
+                config->setReusePort(reusePort);
+
+                config->setIPv6Only();
+            });
 
 #ifdef CONFIG_MQTTSUITE_BROKER_TLS_IPV6
-    express::tls::in6::Server( //
-        "in6-https",
-        router,
-        reportState,
-        [](net::in6::stream::tls::config::ConfigSocketServer* config) {
-            config->setPort(8088);
-            config->setRetry();
-            config->setDisableNagleAlgorithm();
-
-            config->setIPv6Only();
-        });
+        express::tls::in6::Server( //
+            "in6-https",
+            router,
+            reportState,
+            [reusePort](net::in6::stream::tls::config::ConfigSocketServer* config) {
+                config->setPort(8088);
+                config->setRetry();
+                config->setDisableNagleAlgorithm();
+                config->setReusePort(reusePort);
+
+                config->setIPv6Only();
+            });
 #endif
 #endif
 
 #ifdef CONFIG_MQTTSUITE_BROKER_UNIX
-    express::legacy::un::Server( //
-        "un-http",
-        router,
-        reportState,
-        [](net::un::stream::legacy::config::ConfigSocketServer* config) {
-            config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
-        });
+        express::legacy::un::Server( //
+            "un-http",
+            router,
+            reportState,
+            [](net::un::stream::legacy::config::ConfigSocketServer* config) {
+                config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
+            });
 
 #ifdef CONFIG_MQTTSUITE_BROKER_UNIX_TLS
-    express::tls::un::Server( //
-        "un-https",
-        router,
-        reportState,
-        [](net::un::stream::tls::config::ConfigSocketServer* config) {
-            config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
-        });
+        express::tls::un::Server( //
+            "un-https",
+            router,
+            reportState,
+            [](net::un::stream::tls::config::ConfigSocketServer* config) {
+                config->setSunPath("/tmp/" + utils::Config::getApplicationName() + "-" + config->getInstanceName());
+            });
 #endif
 #endif
+    }
 
     return core::SNodeC::start();
 }
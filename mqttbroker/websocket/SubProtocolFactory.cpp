@@ -69,7 +69,8 @@ namespace mqtt::mqttbroker::websocket {
                 subProtocolContext->getSocketConnection()->getConnectionName(),
                 iot::mqtt::server::broker::Broker::instance(
                     SUBSCRIPTION_MAX_QOS, utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getSessionStore()),
-                utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper()));
+                utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMqttMapper(),
+                utils::Config::configRoot.getSubCommand<mqtt::lib::ConfigMqttBroker>()->getMappingMaxChainDepth()));
     }
 
 } // namespace mqtt::mqttbroker::websocket
@@ -41,11 +41,11 @@
 
 #include "SocketContextFactory.h"
 
-#include "lib/ConfigSections.h"
-#include "lib/Mqtt.h"
+#include "lib/MqttFactory.h"
 
 #include <core/socket/stream/SocketConnection.h>
 #include <iot/mqtt/SocketContext.h>
+#include <iot/mqtt/client/Mqtt.h>
 #include <net/config/ConfigInstance.h>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -57,26 +57,8 @@
 namespace mqtt::mqttcli {
 
     core::socket::stream::SocketContext* SocketContextFactory::create(core::socket::stream::SocketConnection* socketConnection) {
-        const lib::ConfigSession* configSession = socketConnection->getConfigInstance()->getSubCommand<lib::ConfigSession>();
-        const lib::ConfigSubscribe* configSubscribe = socketConnection->getConfigInstance()->getSubCommand<lib::ConfigSubscribe>();
-        const lib::ConfigPublish* configPublish = socketConnection->getConfigInstance()->getSubCommand<lib::ConfigPublish>();
-
-        return new iot::mqtt::SocketContext(socketConnection,
-                                            new ::mqtt::mqttcli::lib::Mqtt(socketConnection->getConnectionName(),
-                                                                           configSession->getClientId(),
-                                                                           configSession->getQoS(),
-                                                                           configSession->getKeepAlive(),
-                                                                           !configSession->getRetainSession(),
-                                                                           configSession->getWillTopic(),
-                                                                           configSession->getWillMessage(),
-                                                                           configSession->getWillQoS(),
-                                                                           configSession->getWillRetain(),
-                                                                           configSession->getUsername(),
-                                                                           configSession->getPassword(),
-                                                                           configSubscribe->getTopic(),
-                                                                           configPublish->getTopic(),
-                                                                           configPublish->getMessage(),
-                                                                           configPublish->getRetain()));
+        return new iot::mqtt::SocketContext(
+            socketConnection, lib::createMqtt(socketConnection->getConnectionName(), socketConnection->getConfigInstance()));
     }
 
 } // namespace mqtt::mqttcli
@@ -0,0 +1,262 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Bench.h"
+
+#include "BenchMqtt.h"
+
+#include <core/SNodeC.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <log/Logger.h>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static std::string replaceAll(std::string string, const std::string& placeholder, const std::string& value) {
+        for (std::size_t pos = string.find(placeholder); pos != std::string::npos; pos = string.find(placeholder, pos + value.size())) {
+            string.replace(pos, placeholder.size(), value);
+        }
+
+        return string;
+    }
+
+    Bench& Bench::instance() {
+        static Bench bench;
+
+        return bench;
+    }
+
+    void Bench::setParameters(const Parameters& parameters) {
+        if (!parametersSet) {
+            this->parameters = parameters;
+            parametersSet = true;
+        }
+    }
+
+    const Bench::Parameters& Bench::getParameters() const {
+        return parameters;
+    }
+
+    std::size_t Bench::getConnections() const {
+        return parameters.publishers + parameters.subscribers;
+    }
+
+    Bench::Role Bench::join(BenchMqtt* benchMqtt) {
+        Role role = Role::None;
+
+        if (!started && subscribers.size() < parameters.subscribers) {
+            subscribers.insert(benchMqtt);
+            role = Role::Subscriber;
+        } else if (!finished && publishers.size() < parameters.publishers) {
+            const std::size_t publisherIndex = nextPublisherIndex++;
+            publishers[benchMqtt] = publisherIndex;
+            role = Role::Publisher;
+
+            if (started) { // Replaces a publisher which lost its connection
+                benchMqtt->startPublishing(publisherIndex, parameters.rate / static_cast<double>(parameters.publishers));
+            } else {
+                checkStart();
+            }
+        }
+
+        return role;
+    }
+
+    void Bench::leave(BenchMqtt* benchMqtt) {
+        subscribers.erase(benchMqtt);
+        subscribedSubscribers.erase(benchMqtt);
+        publishers.erase(benchMqtt);
+    }
+
+    void Bench::subscribed(BenchMqtt* benchMqtt) {
+        if (subscribers.contains(benchMqtt)) {
+            subscribedSubscribers.insert(benchMqtt);
+
+            checkStart();
+        }
+    }
+
+    std::string Bench::getTopic(std::size_t publisherIndex, uint64_t sequence) const {
+        return replaceAll(replaceAll(parameters.topicPattern, "%i", std::to_string(publisherIndex)),
+                          "%n",
+                          std::to_string(sequence % parameters.topics));
+    }
+
+    std::string Bench::getTopicFilter() const {
+        return replaceAll(replaceAll(parameters.topicPattern, "%i", "+"), "%n", "+");
+    }
+
+    std::string Bench::getPayload(uint64_t sequence) const {
+        std::string payload(std::max(parameters.payloadSize, headerSize), 'x');
+
+        const uint64_t timestamp = now();
+        std::memcpy(payload.data(), &timestamp, sizeof(timestamp));
+        std::memcpy(payload.data() + sizeof(timestamp), &sequence, sizeof(sequence));
+
+        return payload;
+    }
+
+    void Bench::countPublished(std::size_t bytes) {
+        published++;
+        publishedBytes += bytes;
+    }
+
+    void Bench::countAcknowledged() {
+        acknowledged++;
+    }
+
+    void Bench::countReceived(const std::string& payload) {
+        if (started && payload.size() >= headerSize) {
+            uint64_t timestamp = 0;
+            std::memcpy(&timestamp, payload.data(), sizeof(timestamp));
+
+            const uint64_t receiveTimestamp = now();
+
+            received++;
+            receivedBytes += payload.size();
+            latencies.record(receiveTimestamp > timestamp ? (receiveTimestamp - timestamp) / 1000 : 0);
+        }
+    }
+
+    void Bench::checkStart() {
+        if (!started && subscribedSubscribers.size() == parameters.subscribers && publishers.size() == parameters.publishers) {
+            started = true;
+            startTimePoint = std::chrono::steady_clock::now();
+
+            VLOG(1) << "Bench: Starting with " << parameters.publishers << " publishers and " << parameters.subscribers << " subscribers";
+
+            for (const auto& [benchMqtt, publisherIndex] : publishers) {
+                benchMqtt->startPublishing(publisherIndex, parameters.rate / static_cast<double>(parameters.publishers));
+            }
+
+            finishTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    finish();
+                },
+                parameters.duration);
+        }
+    }
+
+    void Bench::finish() {
+        finished = true;
+        finishTimePoint = std::chrono::steady_clock::now();
+
+        for (const auto& [benchMqtt, publisherIndex] : publishers) {
+            benchMqtt->stopPublishing();
+        }
+
+        reportTimer = core::timer::Timer::singleshotTimer(
+            [this] {
+                report();
+
+                // Collected first as disconnecting leaves the bench
+                std::vector<BenchMqtt*> benchMqtts;
+                for (const auto& [benchMqtt, publisherIndex] : publishers) {
+                    benchMqtts.push_back(benchMqtt);
+                }
+                benchMqtts.insert(benchMqtts.end(), subscribers.begin(), subscribers.end());
+
+                for (BenchMqtt* benchMqtt : benchMqtts) {
+                    benchMqtt->disconnect();
+                }
+
+                core::SNodeC::stop();
+            },
+            gracePeriod);
+    }
+
+    void Bench::report() const {
+        const double seconds = std::chrono::duration<double>(finishTimePoint - startTimePoint).count();
+
+        const auto perSecond = [seconds](uint64_t count) -> double {
+            return seconds > 0 ? static_cast<double>(count) / seconds : 0;
+        };
+
+        if (parameters.json) {
+            nlohmann::json result;
+
+            result["publishers"] = parameters.publishers;
+            result["subscribers"] = parameters.subscribers;
+            result["qos"] = parameters.qoS;
+            result["payload_size"] = parameters.payloadSize;
+            result["duration"] = seconds;
+            result["published"] = published;
+            result["acknowledged"] = acknowledged;
+            result["received"] = received;
+            result["publish_rate"] = perSecond(published);
+            result["publish_throughput"] = perSecond(publishedBytes);
+            result["receive_rate"] = perSecond(received);
+            result["receive_throughput"] = perSecond(receivedBytes);
+            result["latency_us"] = {{"min", latencies.getMin()},
+                                    {"mean", latencies.getMean()},
+                                    {"p50", latencies.getValueAtPercentile(50)},
+                                    {"p99", latencies.getValueAtPercentile(99)},
+                                    {"p999", latencies.getValueAtPercentile(99.9)},
+                                    {"max", latencies.getMax()}};
+
+            std::cout << result.dump() << std::endl;
+        } else {
+            VLOG(0) << "Bench: " << parameters.publishers << " publishers, " << parameters.subscribers << " subscribers, QoS "
+                    << static_cast<int>(parameters.qoS) << ", " << parameters.payloadSize << " bytes payload, " << seconds << " seconds";
+            VLOG(0) << "  Published: " << published << " (" << perSecond(published) << " msg/s, " << perSecond(publishedBytes)
+                    << " byte/s), acknowledged: " << acknowledged;
+            VLOG(0) << "  Received:  " << received << " (" << perSecond(received) << " msg/s, " << perSecond(receivedBytes) << " byte/s)";
+            VLOG(0) << "  Latency:   min " << latencies.getMin() << " us, p50 " << latencies.getValueAtPercentile(50) << " us, p99 "
+                    << latencies.getValueAtPercentile(99) << " us, p999 " << latencies.getValueAtPercentile(99.9) << " us, max "
+                    << latencies.getMax() << " us";
+        }
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,143 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_BENCH_H
+#define MQTTCLI_LIB_BENCH_H
+
+#include "LatencyHistogram.h"
+
+#include <core/timer/Timer.h>
+
+namespace mqtt::mqttcli::lib {
+    class BenchMqtt;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Coordinates the connections of a load generator run. The first connections to be established become subscribers, the remaining
+    // ones publishers. Publishing starts once all subscriptions are acknowledged and stops after the configured duration, the result
+    // is reported after a grace period for the messages still in flight.
+    class Bench {
+    public:
+        enum class Role { None, Publisher, Subscriber };
+
+        struct Parameters {
+            std::string topicPattern;
+            std::size_t publishers = 1;
+            std::size_t subscribers = 1;
+            double rate = 1000;
+            std::size_t payloadSize = 64;
+            std::size_t topics = 1;
+            double duration = 10;
+            uint8_t qoS = 0;
+            bool json = false;
+        };
+
+        static constexpr std::size_t headerSize = 2 * sizeof(uint64_t); // Send timestamp and sequence number
+
+    private:
+        Bench() = default;
+
+    public:
+        static Bench& instance();
+
+        void setParameters(const Parameters& parameters); // The first call wins, every connection passes the same parameters
+        const Parameters& getParameters() const;
+        std::size_t getConnections() const;
+
+        Role join(BenchMqtt* benchMqtt);
+        void leave(BenchMqtt* benchMqtt);
+        void subscribed(BenchMqtt* benchMqtt);
+
+        std::string getTopic(std::size_t publisherIndex, uint64_t sequence) const;
+        std::string getTopicFilter() const;
+        std::string getPayload(uint64_t sequence) const;
+
+        void countPublished(std::size_t bytes);
+        void countAcknowledged();
+        void countReceived(const std::string& payload);
+
+    private:
+        void checkStart();
+        void finish();
+        void report() const;
+
+        Parameters parameters;
+        bool parametersSet = false;
+
+        std::set<BenchMqtt*> subscribers;
+        std::set<BenchMqtt*> subscribedSubscribers;
+        std::map<BenchMqtt*, std::size_t> publishers; // Publisher and its index
+        std::size_t nextPublisherIndex = 0;
+
+        bool started = false;
+        bool finished = false;
+        std::chrono::steady_clock::time_point startTimePoint;
+        std::chrono::steady_clock::time_point finishTimePoint;
+
+        uint64_t published = 0;
+        uint64_t publishedBytes = 0;
+        uint64_t acknowledged = 0;
+        uint64_t received = 0;
+        uint64_t receivedBytes = 0;
+        LatencyHistogram latencies; // Microseconds
+
+        core::timer::Timer finishTimer;
+        core::timer::Timer reportTimer;
+
+        static constexpr double gracePeriod = 1;
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_BENCH_H
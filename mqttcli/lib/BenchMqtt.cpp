@@ -0,0 +1,164 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "BenchMqtt.h"
+
+#include <iot/mqtt/Topic.h>
+#include <iot/mqtt/packets/Connack.h>
+#include <iot/mqtt/packets/Publish.h>
+#include <iot/mqtt/packets/Suback.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <log/Logger.h>
+#include <utils/system/signal.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    BenchMqtt::BenchMqtt(const std::string& connectionName,
+                         const std::string& clientId,
+                         uint16_t keepAlive,
+                         const std::string& username,
+                         const std::string& password)
+        : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive)
+        , username(username)
+        , password(password) {
+        VLOG(1) << "Client Id: " << clientId;
+    }
+
+    void BenchMqtt::startPublishing(std::size_t publisherIndex, double rate) {
+        this->publisherIndex = publisherIndex;
+        this->rate = rate;
+        sequence = 0;
+        publishStartTimePoint = std::chrono::steady_clock::now();
+
+        publishTimer = core::timer::Timer::intervalTimer(
+            [this] {
+                publishDue();
+            },
+            publishTick);
+    }
+
+    void BenchMqtt::stopPublishing() {
+        publishTimer.cancel();
+    }
+
+    void BenchMqtt::disconnect() {
+        stopPublishing();
+
+        sendDisconnect();
+    }
+
+    void BenchMqtt::onConnected() {
+        VLOG(1) << "MQTT: Initiating Session";
+
+        sendConnect(true, "", "", 0, false, username, password);
+    }
+
+    void BenchMqtt::onDisconnected() {
+        stopPublishing();
+
+        Bench::instance().leave(this);
+
+        VLOG(1) << "MQTT: Disconnected";
+    }
+
+    bool BenchMqtt::onSignal(int signum) {
+        VLOG(1) << "MQTT: On Exit due to '" << strsignal(signum) << "' (SIG" << utils::system::sigabbrev_np(signum) << " = " << signum
+                << ")";
+
+        disconnect();
+
+        return Super::onSignal(signum);
+    }
+
+    void BenchMqtt::onConnack(const iot::mqtt::packets::Connack& connack) {
+        if (connack.getReturnCode() == 0) {
+            role = Bench::instance().join(this);
+
+            if (role == Bench::Role::Subscriber) {
+                sendSubscribe({iot::mqtt::Topic(Bench::instance().getTopicFilter(), Bench::instance().getParameters().qoS)});
+            } else if (role == Bench::Role::None) {
+                sendDisconnect();
+            }
+        } else {
+            sendDisconnect();
+        }
+    }
+
+    void BenchMqtt::onSuback([[maybe_unused]] const iot::mqtt::packets::Suback& suback) {
+        Bench::instance().subscribed(this);
+    }
+
+    void BenchMqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
+        Bench::instance().countReceived(publish.getMessage());
+    }
+
+    void BenchMqtt::onPuback([[maybe_unused]] const iot::mqtt::packets::Puback& puback) {
+        Bench::instance().countAcknowledged();
+    }
+
+    void BenchMqtt::onPubcomp([[maybe_unused]] const iot::mqtt::packets::Pubcomp& pubcomp) {
+        Bench::instance().countAcknowledged();
+    }
+
+    void BenchMqtt::publishDue() {
+        const Bench& bench = Bench::instance();
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - publishStartTimePoint).count();
+        const uint64_t due = std::min(static_cast<uint64_t>(elapsed * rate), sequence + maxBurst);
+
+        for (; sequence < due; sequence++) {
+            const std::string payload = bench.getPayload(sequence);
+
+            sendPublish(bench.getTopic(publisherIndex, sequence), payload, bench.getParameters().qoS, false);
+
+            Bench::instance().countPublished(payload.size());
+        }
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,107 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_BENCHMQTT_H
+#define MQTTCLI_LIB_BENCHMQTT_H
+
+#include "Bench.h"
+
+#include <core/timer/Timer.h>
+#include <iot/mqtt/client/Mqtt.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // One connection of a load generator run, publishing or subscribing as assigned by Bench
+    class BenchMqtt : public iot::mqtt::client::Mqtt {
+    public:
+        explicit BenchMqtt(const std::string& connectionName,
+                           const std::string& clientId,
+                           uint16_t keepAlive,
+                           const std::string& username,
+                           const std::string& password);
+
+        void startPublishing(std::size_t publisherIndex, double rate);
+        void stopPublishing();
+        void disconnect();
+
+    private:
+        using Super = iot::mqtt::client::Mqtt;
+
+        void onConnected() final;
+        void onDisconnected() final;
+        [[nodiscard]] bool onSignal(int signum) final;
+
+        void onConnack(const iot::mqtt::packets::Connack& connack) final;
+        void onSuback(const iot::mqtt::packets::Suback& suback) final;
+        void onPublish(const iot::mqtt::packets::Publish& publish) final;
+        void onPuback(const iot::mqtt::packets::Puback& puback) final;
+        void onPubcomp(const iot::mqtt::packets::Pubcomp& pubcomp) final;
+
+        void publishDue();
+
+        const std::string username;
+        const std::string password;
+
+        Bench::Role role = Bench::Role::None;
+
+        std::size_t publisherIndex = 0;
+        double rate = 0;
+        uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point publishStartTimePoint;
+        core::timer::Timer publishTimer;
+
+        static constexpr double publishTick = 0.001;
+        static constexpr uint64_t maxBurst = 10000; // Publishes per tick, a publisher falling behind catches up gradually
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_BENCHMQTT_H
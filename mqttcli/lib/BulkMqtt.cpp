@@ -0,0 +1,275 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "BulkMqtt.h"
+
+#include <core/SNodeC.h>
+#include <iot/mqtt/packets/Connack.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <log/Logger.h>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+#include <utils/system/signal.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    BulkMqtt::BulkMqtt(const std::string& connectionName,
+                       const std::string& clientId,
+                       uint16_t keepAlive,
+                       const std::string& username,
+                       const std::string& password,
+                       uint8_t qoS,
+                       const std::string& path,
+                       Format format,
+                       std::size_t window,
+                       bool retain)
+        : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive)
+        , username(username)
+        , password(password)
+        , qoS(qoS)
+        , path(path)
+        , format(format)
+        , window(window)
+        , retain(retain) {
+        VLOG(1) << "Client Id: " << clientId;
+        VLOG(1) << "  Input: " << path;
+        VLOG(1) << "  Window: " << window;
+    }
+
+    BulkMqtt::~BulkMqtt() {
+        publishTimer.cancel();
+
+        if (fd >= 0 && fdFlags >= 0) {
+            ::fcntl(fd, F_SETFL, fdFlags);
+        }
+
+        if (fd > STDIN_FILENO) {
+            ::close(fd);
+        }
+    }
+
+    void BulkMqtt::onConnected() {
+        VLOG(1) << "MQTT: Initiating Session";
+
+        sendConnect(true, "", "", 0, false, username, password);
+    }
+
+    void BulkMqtt::onDisconnected() {
+        publishTimer.cancel();
+
+        VLOG(1) << "MQTT: Disconnected";
+
+        // The broker closes the connection after the DISCONNECT, thus all publishes before it have been sent
+        if (finished) {
+            core::SNodeC::stop();
+        }
+    }
+
+    bool BulkMqtt::onSignal(int signum) {
+        VLOG(1) << "MQTT: On Exit due to '" << strsignal(signum) << "' (SIG" << utils::system::sigabbrev_np(signum) << " = " << signum
+                << ")";
+
+        sendDisconnect();
+
+        return Super::onSignal(signum);
+    }
+
+    void BulkMqtt::onConnack(const iot::mqtt::packets::Connack& connack) {
+        fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (connack.getReturnCode() == 0 && fd >= 0) {
+            // A pipe or terminal must not block the event loop, missing input is polled for. The flags are restored on destruction as
+            // they are shared with all other users of an inherited stdin
+            fdFlags = ::fcntl(fd, F_GETFL);
+            ::fcntl(fd, F_SETFL, fdFlags | O_NONBLOCK);
+
+            startTimePoint = std::chrono::steady_clock::now();
+
+            publishRecords();
+        } else {
+            if (fd < 0) {
+                VLOG(0) << "MQTT Bulk: Cannot open '" << path << "': " << std::strerror(errno);
+            }
+
+            sendDisconnect();
+        }
+    }
+
+    void BulkMqtt::onPuback([[maybe_unused]] const iot::mqtt::packets::Puback& puback) {
+        acknowledged();
+    }
+
+    void BulkMqtt::onPubcomp([[maybe_unused]] const iot::mqtt::packets::Pubcomp& pubcomp) {
+        acknowledged();
+    }
+
+    void BulkMqtt::acknowledged() {
+        acknowledgedCount++;
+
+        if (inFlight > 0 && inFlight-- == window) {
+            publishRecords(); // The window has room again
+        } else if (inFlight == 0 && endOfInput && inputPosition == input.size()) {
+            finish();
+        }
+    }
+
+    void BulkMqtt::publishRecords() {
+        bool waitForInput = false;
+
+        for (uint64_t burst = 0; burst < maxBurst && inFlight < window && !waitForInput;) {
+            const std::size_t lineEnd = input.find('\n', inputPosition);
+
+            if (lineEnd != std::string::npos) {
+                publishRecord(std::string_view(input).substr(inputPosition, lineEnd - inputPosition));
+                inputPosition = lineEnd + 1;
+                burst++;
+            } else if (endOfInput) {
+                if (inputPosition < input.size()) { // Last line without newline
+                    publishRecord(std::string_view(input).substr(inputPosition));
+                    inputPosition = input.size();
+                }
+                break;
+            } else {
+                waitForInput = !readInput();
+            }
+        }
+
+        if (endOfInput && inputPosition == input.size()) {
+            if (inFlight == 0) {
+                finish();
+            }
+        } else if (inFlight < window) {
+            publishTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    publishRecords();
+                },
+                waitForInput ? inputRetryInterval : 0);
+        }
+    }
+
+    bool BulkMqtt::readInput() {
+        input.erase(0, inputPosition);
+        inputPosition = 0;
+
+        const std::size_t size = input.size();
+        input.resize(size + readSize);
+
+        const ssize_t ret = ::read(fd, input.data() + size, readSize);
+        input.resize(size + static_cast<std::size_t>(ret > 0 ? ret : 0));
+
+        if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EINTR)) {
+            endOfInput = true;
+        }
+
+        return ret > 0 || endOfInput;
+    }
+
+    void BulkMqtt::publishRecord(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (!line.empty()) {
+            std::string topic;
+            std::string message;
+            uint8_t recordQoS = qoS;
+            bool recordRetain = retain;
+
+            if (format == Format::Tsv) {
+                const std::size_t tab = line.find('\t');
+
+                if (tab != std::string_view::npos) {
+                    topic = line.substr(0, tab);
+                    message = line.substr(tab + 1);
+                }
+            } else {
+                const nlohmann::json record = nlohmann::json::parse(line, nullptr, false);
+
+                // Records with a qos or retain of the wrong type or out of range are malformed, value() would throw on them
+                if (record.is_object() && record.contains("topic") && record["topic"].is_string() &&
+                    (!record.contains("qos") || (record["qos"].is_number_integer() && record["qos"] >= 0 && record["qos"] <= 2)) &&
+                    (!record.contains("retain") || record["retain"].is_boolean())) {
+                    topic = record["topic"];
+
+                    const nlohmann::json payload = record.value("payload", record.value("message", nlohmann::json()));
+                    message = payload.is_string() ? payload.get<std::string>() : payload.is_null() ? "" : payload.dump();
+
+                    recordQoS = static_cast<uint8_t>(record.value("qos", static_cast<int>(qoS)));
+                    recordRetain = record.value("retain", retain);
+                }
+            }
+
+            if (!topic.empty()) {
+                sendPublish(topic, message, recordQoS, recordRetain);
+                published++;
+
+                if (recordQoS > 0) {
+                    inFlight++;
+                }
+            } else {
+                malformed++;
+            }
+        }
+    }
+
+    void BulkMqtt::finish() {
+        if (!finished) {
+            finished = true;
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTimePoint).count();
+
+            VLOG(0) << "MQTT Bulk: " << published << " messages published, " << acknowledgedCount << " acknowledged, " << malformed
+                    << " malformed records skipped in " << seconds << " seconds ("
+                    << (seconds > 0 ? static_cast<double>(published) / seconds : 0) << " msg/s)";
+
+            sendDisconnect();
+        }
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,131 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_BULKMQTT_H
+#define MQTTCLI_LIB_BULKMQTT_H
+
+#include <core/timer/Timer.h>
+#include <iot/mqtt/client/Mqtt.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Streams topic<TAB>payload or NDJSON records from a file or stdin over one connection. QoS 1/2 publishes are pipelined with at
+    // most window of them unacknowledged. Once the input is exhausted and all acknowledgements are in the throughput is reported and
+    // the application stops.
+    class BulkMqtt : public iot::mqtt::client::Mqtt {
+    public:
+        enum class Format { Tsv, NdJson };
+
+        explicit BulkMqtt(const std::string& connectionName,
+                          const std::string& clientId,
+                          uint16_t keepAlive,
+                          const std::string& username,
+                          const std::string& password,
+                          uint8_t qoS,
+                          const std::string& path,
+                          Format format,
+                          std::size_t window,
+                          bool retain);
+
+        BulkMqtt(const BulkMqtt&) = delete;
+        BulkMqtt& operator=(const BulkMqtt&) = delete;
+
+        ~BulkMqtt() override;
+
+    private:
+        using Super = iot::mqtt::client::Mqtt;
+
+        void onConnected() final;
+        void onDisconnected() final;
+        [[nodiscard]] bool onSignal(int signum) final;
+
+        void onConnack(const iot::mqtt::packets::Connack& connack) final;
+        void onPuback(const iot::mqtt::packets::Puback& puback) final;
+        void onPubcomp(const iot::mqtt::packets::Pubcomp& pubcomp) final;
+
+        void publishRecords();
+        bool readInput();
+        void publishRecord(std::string_view line);
+        void acknowledged();
+        void finish();
+
+        const std::string username;
+        const std::string password;
+        const uint8_t qoS;
+        const std::string path;
+        const Format format;
+        const std::size_t window;
+        const bool retain;
+
+        int fd = -1;
+        int fdFlags = -1; // Of fd before O_NONBLOCK was added
+        bool endOfInput = false;
+        std::string input;
+        std::size_t inputPosition = 0;
+
+        std::size_t inFlight = 0;
+        uint64_t published = 0;
+        uint64_t acknowledgedCount = 0;
+        uint64_t malformed = 0;
+        bool finished = false;
+        std::chrono::steady_clock::time_point startTimePoint;
+
+        core::timer::Timer publishTimer;
+
+        static constexpr std::size_t readSize = 64 * 1024;
+        static constexpr uint64_t maxBurst = 1000; // Publishes per event loop iteration
+        static constexpr double inputRetryInterval = 0.01;
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_BULKMQTT_H
@@ -0,0 +1,287 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "Capture.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <log/Logger.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    template <typename Value>
+    static void appendValue(std::string& buffer, Value value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename Value>
+    static Value readValue(const char* data) {
+        Value value;
+        std::memcpy(&value, data, sizeof(value));
+
+        return value;
+    }
+
+    std::string capture::getIndexPath(const std::string& path) {
+        return path + ".idx";
+    }
+
+    CaptureWriter::CaptureWriter(const std::string& path, bool withIndex)
+        : path(path)
+        , fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) {
+        if (fd >= 0) {
+            std::string header(capture::magic, sizeof(capture::magic));
+            appendValue(header, capture::formatVersion);
+            appendValue(header, uint32_t{0});
+
+            if (!writeAll(fd, header)) {
+                VLOG(0) << "Capture: Writing '" << path << "' failed: " << std::strerror(errno);
+            }
+
+            if (withIndex) {
+                indexFd = ::open(capture::getIndexPath(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+                if (indexFd < 0) {
+                    VLOG(0) << "Capture: Cannot open '" << capture::getIndexPath(path) << "': " << std::strerror(errno);
+                }
+            }
+        } else {
+            VLOG(0) << "Capture: Cannot open '" << path << "': " << std::strerror(errno);
+        }
+    }
+
+    CaptureWriter::~CaptureWriter() {
+        flush();
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (indexFd >= 0) {
+            ::close(indexFd);
+        }
+    }
+
+    bool CaptureWriter::isOpen() const {
+        return fd >= 0;
+    }
+
+    void CaptureWriter::append(uint64_t timestamp, std::string_view topic, std::string_view payload, uint8_t qoS, bool retain) {
+        if (fd >= 0) {
+            if (indexFd >= 0 && recordCount % capture::indexInterval == 0) {
+                appendValue(indexBuffer, timestamp);
+                appendValue(indexBuffer, offset);
+            }
+
+            const std::size_t recordSize = capture::recordHeaderSize + topic.size() + payload.size();
+
+            appendValue(buffer, static_cast<uint32_t>(recordSize - sizeof(uint32_t)));
+            appendValue(buffer, timestamp);
+            appendValue(buffer, qoS);
+            appendValue(buffer, static_cast<uint8_t>(retain ? 1 : 0));
+            appendValue(buffer, static_cast<uint16_t>(topic.size()));
+            buffer.append(topic).append(payload);
+
+            offset += recordSize;
+            recordCount++;
+
+            if (buffer.size() > maxBufferSize) {
+                flush();
+            } else if (!flushScheduled) {
+                flushScheduled = true;
+
+                flushTimer = core::timer::Timer::singleshotTimer(
+                    [this] {
+                        flushScheduled = false;
+                        flush();
+                    },
+                    0);
+            }
+        }
+    }
+
+    void CaptureWriter::flush() {
+        if (fd >= 0 && !buffer.empty()) {
+            if (!writeAll(fd, buffer)) {
+                VLOG(0) << "Capture: Writing '" << path << "' failed: " << std::strerror(errno);
+            }
+            buffer.clear();
+        }
+
+        if (indexFd >= 0 && !indexBuffer.empty()) {
+            if (!writeAll(indexFd, indexBuffer)) {
+                VLOG(0) << "Capture: Writing '" << capture::getIndexPath(path) << "' failed: " << std::strerror(errno);
+            }
+            indexBuffer.clear();
+        }
+    }
+
+    bool CaptureWriter::writeAll(int fd, const std::string& data) {
+        std::size_t written = 0;
+
+        while (written < data.size()) {
+            const ssize_t ret = ::write(fd, data.data() + written, data.size() - written);
+
+            if (ret > 0) {
+                written += static_cast<std::size_t>(ret);
+            } else if (ret < 0 && errno != EINTR) {
+                break;
+            }
+        }
+
+        return written == data.size();
+    }
+
+    CaptureReader::CaptureReader(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        struct stat fileStat {};
+        if (fd >= 0 && ::fstat(fd, &fileStat) == 0 && static_cast<std::size_t>(fileStat.st_size) >= capture::headerSize) {
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (mapping != MAP_FAILED) {
+                data = static_cast<const char*>(mapping);
+                size = static_cast<std::size_t>(fileStat.st_size);
+
+                if (std::memcmp(data, capture::magic, sizeof(capture::magic)) != 0 ||
+                    readValue<uint32_t>(data + sizeof(capture::magic)) != capture::formatVersion) {
+                    VLOG(0) << "Capture: '" << path << "' is not a capture file of version " << capture::formatVersion;
+
+                    ::munmap(mapping, size);
+                    data = nullptr;
+                    size = 0;
+                } else {
+                    ::madvise(mapping, size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+
+        if (data == nullptr) {
+            VLOG(0) << "Capture: Cannot map '" << path << "'";
+        }
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        position = capture::headerSize;
+
+        const int indexFd = ::open(capture::getIndexPath(path).c_str(), O_RDONLY | O_CLOEXEC);
+        if (indexFd >= 0) {
+            uint64_t entry[2];
+            while (::read(indexFd, entry, sizeof(entry)) == static_cast<ssize_t>(sizeof(entry))) {
+                if (entry[1] < size) {
+                    index.emplace_back(entry[0], entry[1]);
+                }
+            }
+
+            ::close(indexFd);
+        }
+    }
+
+    CaptureReader::~CaptureReader() {
+        if (data != nullptr) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    bool CaptureReader::isOpen() const {
+        return data != nullptr;
+    }
+
+    bool CaptureReader::next(Record& record) {
+        bool valid = false;
+
+        if (data != nullptr && position + capture::recordHeaderSize <= size) {
+            const std::size_t recordSize = sizeof(uint32_t) + readValue<uint32_t>(data + position);
+            const std::size_t topicSize = readValue<uint16_t>(data + position + capture::recordHeaderSize - sizeof(uint16_t));
+
+            if (recordSize >= capture::recordHeaderSize + topicSize && position + recordSize <= size) {
+                const char* field = data + position + sizeof(uint32_t);
+
+                record.timestamp = readValue<uint64_t>(field);
+                record.qoS = readValue<uint8_t>(field + sizeof(uint64_t));
+                record.retain = readValue<uint8_t>(field + sizeof(uint64_t) + sizeof(uint8_t)) != 0;
+                record.topic = std::string_view(data + position + capture::recordHeaderSize, topicSize);
+                record.payload = std::string_view(data + position + capture::recordHeaderSize + topicSize,
+                                                  recordSize - capture::recordHeaderSize - topicSize);
+
+                position += recordSize;
+                valid = true;
+            }
+        }
+
+        return valid;
+    }
+
+    void CaptureReader::rewind() {
+        position = capture::headerSize;
+    }
+
+    void CaptureReader::seek(uint64_t timestamp) {
+        rewind();
+
+        // Start at the last indexed record before the timestamp and skip the remaining ones linearly
+        const auto indexIt = std::lower_bound(index.begin(), index.end(), std::make_pair(timestamp, uint64_t{0}));
+        if (indexIt != index.begin()) {
+            position = std::prev(indexIt)->second;
+        }
+
+        Record record;
+        for (std::size_t recordPosition = position; next(record); recordPosition = position) {
+            if (record.timestamp >= timestamp) {
+                position = recordPosition;
+                break;
+            }
+        }
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,139 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_CAPTURE_H
+#define MQTTCLI_LIB_CAPTURE_H
+
+#include <core/timer/Timer.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Capture file: a header followed by length prefixed records in host byte order
+    //   record = u32 length of the rest | u64 timestamp (ns since epoch) | u8 qos | u8 retain | u16 topic length | topic | payload
+    // The optional index "<file>.idx" holds (timestamp, file offset) pairs of every indexInterval-th record.
+    namespace capture {
+        constexpr char magic[8] = {'M', 'Q', 'T', 'T', 'C', 'A', 'P', '\0'};
+        constexpr uint32_t formatVersion = 1;
+        constexpr std::size_t headerSize = sizeof(magic) + 2 * sizeof(uint32_t);
+        constexpr std::size_t recordHeaderSize = sizeof(uint32_t) + sizeof(uint64_t) + 2 * sizeof(uint8_t) + sizeof(uint16_t);
+        constexpr uint64_t indexInterval = 1024;
+
+        std::string getIndexPath(const std::string& path);
+    } // namespace capture
+
+    class CaptureWriter {
+    public:
+        CaptureWriter(const std::string& path, bool withIndex);
+
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        ~CaptureWriter();
+
+        bool isOpen() const;
+
+        void append(uint64_t timestamp, std::string_view topic, std::string_view payload, uint8_t qoS, bool retain);
+        void flush();
+
+    private:
+        static bool writeAll(int fd, const std::string& data);
+
+        std::string path;
+        int fd = -1;
+        int indexFd = -1;
+
+        std::string buffer;
+        std::string indexBuffer;
+        uint64_t offset = capture::headerSize;
+        uint64_t recordCount = 0;
+
+        core::timer::Timer flushTimer;
+        bool flushScheduled = false;
+
+        static constexpr std::size_t maxBufferSize = 4 * 1024 * 1024; // Written at once when exceeded
+    };
+
+    class CaptureReader {
+    public:
+        struct Record {
+            uint64_t timestamp = 0;
+            uint8_t qoS = 0;
+            bool retain = false;
+            std::string_view topic;
+            std::string_view payload;
+        };
+
+        explicit CaptureReader(const std::string& path);
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        ~CaptureReader();
+
+        bool isOpen() const;
+
+        bool next(Record& record); // False at the end or at a truncated record
+        void rewind();
+        void seek(uint64_t timestamp); // To the first record at or after timestamp
+
+    private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+        std::size_t position = 0;
+
+        std::vector<std::pair<uint64_t, uint64_t>> index; // Timestamp and offset, empty without index file
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_CAPTURE_H
@@ -43,14 +43,44 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <string_view>
+
 #endif
 
 namespace mqtt::mqttcli::lib {
+
+    // The subscribers replace %i and %n by a single level wildcard, which is only valid for a whole topic level
+    static const CLI::Validator benchTopicPattern(
+        [](const std::string& pattern) -> std::string {
+            std::string error;
+
+            std::size_t levelStart = 0;
+            for (std::size_t levelEnd = 0; levelEnd != std::string::npos && error.empty(); levelStart = levelEnd + 1) {
+                levelEnd = pattern.find('/', levelStart);
+                const std::string_view level = std::string_view(pattern).substr(levelStart, levelEnd - levelStart);
+
+                if ((level.find("%i") != std::string_view::npos || level.find("%n") != std::string_view::npos) && level != "%i" &&
+                    level != "%n") {
+                    error = "%i and %n must fill a whole topic level: " + pattern;
+                }
+            }
+
+            return error;
+        },
+        "PATTERN");
+
     ConfigSubscribe::ConfigSubscribe(utils::SubCommand* parent)
         : utils::SubCommand(parent, this, "Applications (at least one required)")
         , topicOpt( //
               setConfigurable(addOption("--topic", "List of topics subscribing to", "string", CLI::TypeValidator<std::string>()), true)
-                  ->take_all()) {
+                  ->take_all())
+        , outputOpt( //
+              setConfigurable(addOption("--output",
+                                        "Format of received messages: pretty printed log, raw payload or NDJSON on stdout",
+                                        "format",
+                                        "pretty",
+                                        CLI::IsMember({"pretty", "raw", "ndjson"})),
+                              true)) {
         required(topicOpt);
 
         forceUnrequired(true);
@@ -74,6 +104,16 @@ namespace mqtt::mqttcli::lib {
         return *this;
     }
 
+    std::string ConfigSubscribe::getOutput() const {
+        return outputOpt->as<std::string>();
+    }
+
+    const ConfigSubscribe& ConfigSubscribe::setOutput(const std::string& output) {
+        outputOpt->default_val(output);
+
+        return *this;
+    }
+
     ConfigPublish::ConfigPublish(utils::SubCommand* parent)
         : utils::SubCommand(parent, this, "Applications (at least one required)")
         , topicOpt( //
@@ -120,6 +160,399 @@ namespace mqtt::mqttcli::lib {
         return *this;
     }
 
+    ConfigBench::ConfigBench(utils::SubCommand* parent)
+        : utils::SubCommand(parent, this, "Applications (at least one required)")
+        , topicOpt( //
+              setConfigurable(addOption("--topic",
+                                        "Topic pattern, %i is replaced by the publisher index and %n by the message number modulo --topics",
+                                        "string",
+                                        benchTopicPattern),
+                              true))
+        , publishersOpt( //
+              setConfigurable(addOption("--publishers", "Number of publishing connections", "count", "1", CLI::PositiveNumber), true))
+        , subscribersOpt( //
+              setConfigurable(addOption("--subscribers", "Number of subscribing connections", "count", "1", CLI::NonNegativeNumber), true))
+        , rateOpt( //
+              setConfigurable(addOption("--rate", "Total publish rate in messages per second", "rate", "1000", CLI::PositiveNumber), true))
+        , payloadSizeOpt( //
+              setConfigurable(addOption("--payload-size", "Payload size in bytes", "bytes", "64", CLI::Range(16, 268435455)), true))
+        , topicsOpt( //
+              setConfigurable(addOption("--topics", "Number of topics per publisher", "count", "1", CLI::PositiveNumber), true))
+        , durationOpt( //
+              setConfigurable(addOption("--duration", "Measurement duration in seconds", "seconds", "10", CLI::PositiveNumber), true))
+        , outputOpt( //
+              setConfigurable(addOption("--output", "Format of the result", "format", "text", CLI::IsMember({"text", "json"})), true)) {
+        required(topicOpt);
+
+        forceUnrequired(true);
+    }
+
+    ConfigBench::~ConfigBench() = default;
+
+    std::string ConfigBench::getTopic() const {
+        return topicOpt->as<std::string>();
+    }
+
+    const ConfigBench& ConfigBench::setTopic(const std::string& topic) {
+        topicOpt->default_val(topic);
+
+        return *this;
+    }
+
+    std::size_t ConfigBench::getPublishers() const {
+        return publishersOpt->as<std::size_t>();
+    }
+
+    const ConfigBench& ConfigBench::setPublishers(std::size_t publishers) {
+        publishersOpt->default_val(publishers);
+
+        return *this;
+    }
+
+    std::size_t ConfigBench::getSubscribers() const {
+        return subscribersOpt->as<std::size_t>();
+    }
+
+    const ConfigBench& ConfigBench::setSubscribers(std::size_t subscribers) {
+        subscribersOpt->default_val(subscribers);
+
+        return *this;
+    }
+
+    double ConfigBench::getRate() const {
+        return rateOpt->as<double>();
+    }
+
+    const ConfigBench& ConfigBench::setRate(double rate) {
+        rateOpt->default_val(rate);
+
+        return *this;
+    }
+
+    std::size_t ConfigBench::getPayloadSize() const {
+        return payloadSizeOpt->as<std::size_t>();
+    }
+
+    const ConfigBench& ConfigBench::setPayloadSize(std::size_t payloadSize) {
+        payloadSizeOpt->default_val(payloadSize);
+
+        return *this;
+    }
+
+    std::size_t ConfigBench::getTopics() const {
+        return topicsOpt->as<std::size_t>();
+    }
+
+    const ConfigBench& ConfigBench::setTopics(std::size_t topics) {
+        topicsOpt->default_val(topics);
+
+        return *this;
+    }
+
+    double ConfigBench::getDuration() const {
+        return durationOpt->as<double>();
+    }
+
+    const ConfigBench& ConfigBench::setDuration(double duration) {
+        durationOpt->default_val(duration);
+
+        return *this;
+    }
+
+    std::string ConfigBench::getOutput() const {
+        return outputOpt->as<std::string>();
+    }
+
+    const ConfigBench& ConfigBench::setOutput(const std::string& output) {
+        outputOpt->default_val(output);
+
+        return *this;
+    }
+
+    ConfigRecord::ConfigRecord(utils::SubCommand* parent)
+        : utils::SubCommand(parent, this, "Applications (at least one required)")
+        , fileOpt( //
+              setConfigurable(addOption("--file", "Capture file written", "path", CLI::TypeValidator<std::string>()), true))
+        , topicOpt( //
+              setConfigurable(addOption("--topic", "List of topics captured", "string", "#", CLI::TypeValidator<std::string>()), true)
+                  ->take_all())
+        , indexOpt( //
+              setConfigurable(addFlag("--index{true}", "Write an index file", "bool", "false", CLI::IsMember({"true", "false"})), true)) {
+        required(fileOpt);
+
+        forceUnrequired(true);
+    }
+
+    ConfigRecord::~ConfigRecord() = default;
+
+    std::string ConfigRecord::getFile() const {
+        return fileOpt->as<std::string>();
+    }
+
+    const ConfigRecord& ConfigRecord::setFile(const std::string& file) {
+        fileOpt->default_val(file);
+
+        return *this;
+    }
+
+    std::list<std::string> ConfigRecord::getTopic() const {
+        return topicOpt->as<std::list<std::string>>();
+    }
+
+    const ConfigRecord& ConfigRecord::setTopic(const std::string& topic) {
+        topicOpt->default_val(topic);
+
+        return *this;
+    }
+
+    bool ConfigRecord::getIndex() const {
+        return indexOpt->as<bool>();
+    }
+
+    const ConfigRecord& ConfigRecord::setIndex(bool index) {
+        indexOpt->default_val(index);
+
+        return *this;
+    }
+
+    ConfigReplay::ConfigReplay(utils::SubCommand* parent)
+        : utils::SubCommand(parent, this, "Applications (at least one required)")
+        , fileOpt( //
+              setConfigurable(addOption("--file", "Capture file replayed", "path", CLI::ExistingFile), true))
+        , speedOpt( //
+              setConfigurable(addOption("--speed",
+                                        "Speed multiplier of the original timing (0 replays as fast as possible)",
+                                        "factor",
+                                        "1",
+                                        CLI::NonNegativeNumber),
+                              true))
+        , startOpt( //
+              setConfigurable(addOption("--start", "Offset in seconds into the capture", "seconds", "0", CLI::NonNegativeNumber), true))
+        , remapOpt( //
+              setConfigurable(addOption("--remap", "List of topic prefix mappings from=to", "string", CLI::TypeValidator<std::string>()),
+                              true)
+                  ->take_all())
+        , loopOpt( //
+              setConfigurable(addFlag("--loop{true}", "Replay endlessly", "bool", "false", CLI::IsMember({"true", "false"})), true)) {
+        required(fileOpt);
+
+        forceUnrequired(true);
+    }
+
+    ConfigReplay::~ConfigReplay() = default;
+
+    std::string ConfigReplay::getFile() const {
+        return fileOpt->as<std::string>();
+    }
+
+    const ConfigReplay& ConfigReplay::setFile(const std::string& file) {
+        fileOpt->default_val(file);
+
+        return *this;
+    }
+
+    double ConfigReplay::getSpeed() const {
+        return speedOpt->as<double>();
+    }
+
+    const ConfigReplay& ConfigReplay::setSpeed(double speed) {
+        speedOpt->default_val(speed);
+
+        return *this;
+    }
+
+    double ConfigReplay::getStart() const {
+        return startOpt->as<double>();
+    }
+
+    const ConfigReplay& ConfigReplay::setStart(double start) {
+        startOpt->default_val(start);
+
+        return *this;
+    }
+
+    std::list<std::string> ConfigReplay::getRemap() const {
+        std::list<std::string> remapList = remapOpt->as<std::list<std::string>>();
+
+        if (!remapList.empty() && remapList.front().empty()) {
+            remapList.pop_front();
+        }
+
+        return remapList;
+    }
+
+    const ConfigReplay& ConfigReplay::setRemap(const std::string& remap) {
+        remapOpt->default_val(remap);
+
+        return *this;
+    }
+
+    bool ConfigReplay::getLoop() const {
+        return loopOpt->as<bool>();
+    }
+
+    const ConfigReplay& ConfigReplay::setLoop(bool loop) {
+        loopOpt->default_val(loop);
+
+        return *this;
+    }
+
+    ConfigBulk::ConfigBulk(utils::SubCommand* parent)
+        : utils::SubCommand(parent, this, "Applications (at least one required)")
+        , fileOpt( //
+              setConfigurable(
+                  addOption("--file", "File of topic<TAB>payload or NDJSON records, - is stdin", "path", CLI::TypeValidator<std::string>()),
+                  true))
+        , formatOpt( //
+              setConfigurable(addOption("--format", "Record format", "format", "tsv", CLI::IsMember({"tsv", "ndjson"})), true))
+        , windowOpt( //
+              setConfigurable(addOption("--window", "QoS 1/2 publishes in flight", "count", "64", CLI::PositiveNumber), true))
+        , retainOpt( //
+              setConfigurable(addFlag("--retain{true}", "Message retain", "bool", "false", CLI::IsMember({"true", "false"})), true)) {
+        required(fileOpt);
+
+        forceUnrequired(true);
+    }
+
+    ConfigBulk::~ConfigBulk() = default;
+
+    std::string ConfigBulk::getFile() const {
+        return fileOpt->as<std::string>();
+    }
+
+    const ConfigBulk& ConfigBulk::setFile(const std::string& file) {
+        fileOpt->default_val(file);
+
+        return *this;
+    }
+
+    std::string ConfigBulk::getFormat() const {
+        return formatOpt->as<std::string>();
+    }
+
+    const ConfigBulk& ConfigBulk::setFormat(const std::string& format) {
+        formatOpt->default_val(format);
+
+        return *this;
+    }
+
+    std::size_t ConfigBulk::getWindow() const {
+        return windowOpt->as<std::size_t>();
+    }
+
+    const ConfigBulk& ConfigBulk::setWindow(std::size_t window) {
+        windowOpt->default_val(window);
+
+        return *this;
+    }
+
+    bool ConfigBulk::getRetain() const {
+        return retainOpt->as<bool>();
+    }
+
+    const ConfigBulk& ConfigBulk::setRetain(bool retain) {
+        retainOpt->default_val(retain);
+
+        return *this;
+    }
+
+    ConfigProbe::ConfigProbe(utils::SubCommand* parent)
+        : utils::SubCommand(parent, this, "Applications (at least one required)")
+        , topicOpt( //
+              setConfigurable(addOption("--topic", "Topic the probes are published to", "string", CLI::TypeValidator<std::string>()), true))
+        , resultTopicOpt( //
+              setConfigurable(addOption("--result-topic",
+                                        "Topic the probes return on, e.g. after a mapping (default: --topic)",
+                                        "string",
+                                        CLI::TypeValidator<std::string>()),
+                              true))
+        , intervalOpt( //
+              setConfigurable(addOption("--interval", "Seconds between two probes", "seconds", "1", CLI::PositiveNumber), true))
+        , timeoutOpt( //
+              setConfigurable(addOption("--timeout", "Seconds until a probe counts as lost", "seconds", "5", CLI::PositiveNumber), true))
+        , reportIntervalOpt( //
+              setConfigurable(addOption("--report-interval", "Seconds between two reports", "seconds", "10", CLI::PositiveNumber), true))
+        , windowOpt( //
+              setConfigurable(addOption("--window", "Report intervals covered by the statistics", "count", "6", CLI::PositiveNumber), true))
+        , outputOpt( //
+              setConfigurable(addOption("--output", "Format of the reports", "format", "text", CLI::IsMember({"text", "json"})), true)) {
+        required(topicOpt);
+
+        forceUnrequired(true);
+    }
+
+    ConfigProbe::~ConfigProbe() = default;
+
+    std::string ConfigProbe::getTopic() const {
+        return topicOpt->as<std::string>();
+    }
+
+    const ConfigProbe& ConfigProbe::setTopic(const std::string& topic) {
+        topicOpt->default_val(topic);
+
+        return *this;
+    }
+
+    std::string ConfigProbe::getResultTopic() const {
+        return !resultTopicOpt->as<std::string>().empty() ? resultTopicOpt->as<std::string>() : getTopic();
+    }
+
+    const ConfigProbe& ConfigProbe::setResultTopic(const std::string& resultTopic) {
+        resultTopicOpt->default_val(resultTopic);
+
+        return *this;
+    }
+
+    double ConfigProbe::getInterval() const {
+        return intervalOpt->as<double>();
+    }
+
+    const ConfigProbe& ConfigProbe::setInterval(double interval) {
+        intervalOpt->default_val(interval);
+
+        return *this;
+    }
+
+    double ConfigProbe::getTimeout() const {
+        return timeoutOpt->as<double>();
+    }
+
+    const ConfigProbe& ConfigProbe::setTimeout(double timeout) {
+        timeoutOpt->default_val(timeout);
+
+        return *this;
+    }
+
+    double ConfigProbe::getReportInterval() const {
+        return reportIntervalOpt->as<double>();
+    }
+
+    const ConfigProbe& ConfigProbe::setReportInterval(double reportInterval) {
+        reportIntervalOpt->default_val(reportInterval);
+
+        return *this;
+    }
+
+    std::size_t ConfigProbe::getWindow() const {
+        return windowOpt->as<std::size_t>();
+    }
+
+    const ConfigProbe& ConfigProbe::setWindow(std::size_t window) {
+        windowOpt->default_val(window);
+
+        return *this;
+    }
+
+    std::string ConfigProbe::getOutput() const {
+        return outputOpt->as<std::string>();
+    }
+
+    const ConfigProbe& ConfigProbe::setOutput(const std::string& output) {
+        outputOpt->default_val(output);
+
+        return *this;
+    }
+
     ConfigSession::ConfigSession(utils::SubCommand* parent)
         : utils::SubCommand(parent, this, "Applications")
         , clientIdOpt( //
@@ -46,6 +46,7 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+#include <cstddef>
 #include <cstdint>
 #include <list>
 #include <string_view>
@@ -67,8 +68,13 @@ namespace mqtt::mqttcli::lib {
 
         const ConfigSubscribe& setTopic(const std::string& topic);
 
+        std::string getOutput() const;
+
+        const ConfigSubscribe& setOutput(const std::string& output);
+
     private:
         CLI::Option* topicOpt;
+        CLI::Option* outputOpt;
     };
 
     class ConfigPublish : public utils::SubCommand {
@@ -95,6 +101,174 @@ namespace mqtt::mqttcli::lib {
         CLI::Option* retainOpt;
     };
 
+    class ConfigBench : public utils::SubCommand {
+    public:
+        constexpr static std::string_view NAME{"bench"};
+        constexpr static std::string_view DESCRIPTION{"Configuration for the load generator"};
+
+        ConfigBench(utils::SubCommand* parent);
+
+        ~ConfigBench() override;
+
+        std::string getTopic() const;
+        const ConfigBench& setTopic(const std::string& topic);
+
+        std::size_t getPublishers() const;
+        const ConfigBench& setPublishers(std::size_t publishers);
+
+        std::size_t getSubscribers() const;
+        const ConfigBench& setSubscribers(std::size_t subscribers);
+
+        double getRate() const;
+        const ConfigBench& setRate(double rate);
+
+        std::size_t getPayloadSize() const;
+        const ConfigBench& setPayloadSize(std::size_t payloadSize);
+
+        std::size_t getTopics() const;
+        const ConfigBench& setTopics(std::size_t topics);
+
+        double getDuration() const;
+        const ConfigBench& setDuration(double duration);
+
+        std::string getOutput() const;
+        const ConfigBench& setOutput(const std::string& output);
+
+    private:
+        CLI::Option* topicOpt;
+        CLI::Option* publishersOpt;
+        CLI::Option* subscribersOpt;
+        CLI::Option* rateOpt;
+        CLI::Option* payloadSizeOpt;
+        CLI::Option* topicsOpt;
+        CLI::Option* durationOpt;
+        CLI::Option* outputOpt;
+    };
+
+    class ConfigRecord : public utils::SubCommand {
+    public:
+        constexpr static std::string_view NAME{"record"};
+        constexpr static std::string_view DESCRIPTION{"Configuration for capturing traffic"};
+
+        ConfigRecord(utils::SubCommand* parent);
+
+        ~ConfigRecord() override;
+
+        std::string getFile() const;
+        const ConfigRecord& setFile(const std::string& file);
+
+        std::list<std::string> getTopic() const;
+        const ConfigRecord& setTopic(const std::string& topic);
+
+        bool getIndex() const;
+        const ConfigRecord& setIndex(bool index);
+
+    private:
+        CLI::Option* fileOpt;
+        CLI::Option* topicOpt;
+        CLI::Option* indexOpt;
+    };
+
+    class ConfigReplay : public utils::SubCommand {
+    public:
+        constexpr static std::string_view NAME{"replay"};
+        constexpr static std::string_view DESCRIPTION{"Configuration for replaying captured traffic"};
+
+        ConfigReplay(utils::SubCommand* parent);
+
+        ~ConfigReplay() override;
+
+        std::string getFile() const;
+        const ConfigReplay& setFile(const std::string& file);
+
+        double getSpeed() const;
+        const ConfigReplay& setSpeed(double speed);
+
+        double getStart() const;
+        const ConfigReplay& setStart(double start);
+
+        std::list<std::string> getRemap() const;
+        const ConfigReplay& setRemap(const std::string& remap);
+
+        bool getLoop() const;
+        const ConfigReplay& setLoop(bool loop);
+
+    private:
+        CLI::Option* fileOpt;
+        CLI::Option* speedOpt;
+        CLI::Option* startOpt;
+        CLI::Option* remapOpt;
+        CLI::Option* loopOpt;
+    };
+
+    class ConfigBulk : public utils::SubCommand {
+    public:
+        constexpr static std::string_view NAME{"bulk"};
+        constexpr static std::string_view DESCRIPTION{"Configuration for publishing records from a file or stdin"};
+
+        ConfigBulk(utils::SubCommand* parent);
+
+        ~ConfigBulk() override;
+
+        std::string getFile() const;
+        const ConfigBulk& setFile(const std::string& file);
+
+        std::string getFormat() const;
+        const ConfigBulk& setFormat(const std::string& format);
+
+        std::size_t getWindow() const;
+        const ConfigBulk& setWindow(std::size_t window);
+
+        bool getRetain() const;
+        const ConfigBulk& setRetain(bool retain);
+
+    private:
+        CLI::Option* fileOpt;
+        CLI::Option* formatOpt;
+        CLI::Option* windowOpt;
+        CLI::Option* retainOpt;
+    };
+
+    class ConfigProbe : public utils::SubCommand {
+    public:
+        constexpr static std::string_view NAME{"probe"};
+        constexpr static std::string_view DESCRIPTION{"Configuration for the round-trip latency probe"};
+
+        ConfigProbe(utils::SubCommand* parent);
+
+        ~ConfigProbe() override;
+
+        std::string getTopic() const;
+        const ConfigProbe& setTopic(const std::string& topic);
+
+        std::string getResultTopic() const;
+        const ConfigProbe& setResultTopic(const std::string& resultTopic);
+
+        double getInterval() const;
+        const ConfigProbe& setInterval(double interval);
+
+        double getTimeout() const;
+        const ConfigProbe& setTimeout(double timeout);
+
+        double getReportInterval() const;
+        const ConfigProbe& setReportInterval(double reportInterval);
+
+        std::size_t getWindow() const;
+        const ConfigProbe& setWindow(std::size_t window);
+
+        std::string getOutput() const;
+        const ConfigProbe& setOutput(const std::string& output);
+
+    private:
+        CLI::Option* topicOpt;
+        CLI::Option* resultTopicOpt;
+        CLI::Option* intervalOpt;
+        CLI::Option* timeoutOpt;
+        CLI::Option* reportIntervalOpt;
+        CLI::Option* windowOpt;
+        CLI::Option* outputOpt;
+    };
+
     class ConfigSession : public utils::SubCommand {
     public:
         constexpr static std::string_view NAME{"session"};
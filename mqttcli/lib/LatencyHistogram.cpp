@@ -0,0 +1,169 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "LatencyHistogram.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    LatencyHistogram::LatencyHistogram(uint64_t highestTrackableValue, unsigned significantDigits)
+        : highestTrackableValue(std::max<uint64_t>(highestTrackableValue, 2)) {
+        // Enough sub-buckets to resolve 10^significantDigits distinct values within one power of two
+        const uint64_t largestValueWithSingleUnitResolution = 2 * static_cast<uint64_t>(std::pow(10, std::min(significantDigits, 5u)));
+        const unsigned subBucketCountMagnitude = static_cast<unsigned>(std::bit_width(largestValueWithSingleUnitResolution - 1));
+
+        subBucketHalfCountMagnitude = std::max(subBucketCountMagnitude, 1u) - 1;
+        subBucketHalfCount = uint64_t{1} << subBucketHalfCountMagnitude;
+        subBucketMask = (subBucketHalfCount << 1) - 1;
+
+        std::size_t bucketCount = 1;
+        for (uint64_t smallestUntrackableValue = subBucketHalfCount << 1; smallestUntrackableValue <= this->highestTrackableValue &&
+                                                                          smallestUntrackableValue <= (UINT64_MAX >> 1);
+             smallestUntrackableValue <<= 1) {
+            bucketCount++;
+        }
+
+        counts.resize((bucketCount + 1) * subBucketHalfCount);
+    }
+
+    void LatencyHistogram::record(uint64_t value) {
+        value = std::min(value, highestTrackableValue);
+
+        counts[getCountsIndex(value)]++;
+
+        totalCount++;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        sum += static_cast<double>(value);
+    }
+
+    void LatencyHistogram::add(const LatencyHistogram& other) {
+        if (other.counts.size() == counts.size()) {
+            for (std::size_t index = 0; index < counts.size(); index++) {
+                counts[index] += other.counts[index];
+            }
+
+            totalCount += other.totalCount;
+            minValue = std::min(minValue, other.minValue);
+            maxValue = std::max(maxValue, other.maxValue);
+            sum += other.sum;
+        }
+    }
+
+    void LatencyHistogram::reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+
+        totalCount = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+        sum = 0;
+    }
+
+    uint64_t LatencyHistogram::getValueAtPercentile(double percentile) const {
+        uint64_t value = 0;
+
+        if (totalCount > 0) {
+            const double fraction = std::clamp(percentile, 0.0, 100.0) / 100;
+            const uint64_t countAtPercentile =
+                std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(totalCount))));
+
+            uint64_t cumulativeCount = 0;
+            for (std::size_t index = 0; index < counts.size(); index++) {
+                cumulativeCount += counts[index];
+
+                if (cumulativeCount >= countAtPercentile) {
+                    value = std::min(getHighestEquivalentValue(index), maxValue);
+                    break;
+                }
+            }
+        }
+
+        return value;
+    }
+
+    uint64_t LatencyHistogram::getCount() const {
+        return totalCount;
+    }
+
+    uint64_t LatencyHistogram::getMin() const {
+        return totalCount > 0 ? minValue : 0;
+    }
+
+    uint64_t LatencyHistogram::getMax() const {
+        return maxValue;
+    }
+
+    double LatencyHistogram::getMean() const {
+        return totalCount > 0 ? sum / static_cast<double>(totalCount) : 0;
+    }
+
+    std::size_t LatencyHistogram::getCountsIndex(uint64_t value) const {
+        // Bucket 0 holds the values below 2 * subBucketHalfCount with unit resolution, every further bucket doubles the range and the
+        // width of its sub-buckets, of which only the upper half is used as the lower one is covered by the previous buckets
+        const unsigned bucketIndex =
+            static_cast<unsigned>(std::bit_width(value | subBucketMask)) - (subBucketHalfCountMagnitude + 1);
+        const uint64_t subBucketIndex = value >> bucketIndex;
+
+        return static_cast<std::size_t>((uint64_t{bucketIndex} << subBucketHalfCountMagnitude) + subBucketIndex);
+    }
+
+    uint64_t LatencyHistogram::getHighestEquivalentValue(std::size_t countsIndex) const {
+        uint64_t bucketIndex = countsIndex >> subBucketHalfCountMagnitude;
+        uint64_t subBucketIndex = (countsIndex & (subBucketHalfCount - 1)) + subBucketHalfCount;
+
+        if (bucketIndex == 0) {
+            subBucketIndex -= subBucketHalfCount;
+        } else {
+            bucketIndex--;
+        }
+
+        return ((subBucketIndex + 1) << bucketIndex) - 1;
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,92 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_LATENCYHISTOGRAM_H
+#define MQTTCLI_LIB_LATENCYHISTOGRAM_H
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // High dynamic range histogram in the layout of HdrHistogram: values are counted in buckets of exponentially growing width, each
+    // split into linear sub-buckets, which keeps the relative error of every recorded value below 10^-significantDigits at a fixed
+    // memory footprint. Values above the highest trackable value are clamped to it.
+    class LatencyHistogram {
+    public:
+        explicit LatencyHistogram(uint64_t highestTrackableValue = 3'600'000'000, unsigned significantDigits = 3);
+
+        void record(uint64_t value);
+        void add(const LatencyHistogram& other); // Both need to be created with the same parameters
+        void reset();
+
+        uint64_t getValueAtPercentile(double percentile) const;
+        uint64_t getCount() const;
+        uint64_t getMin() const;
+        uint64_t getMax() const;
+        double getMean() const;
+
+    private:
+        std::size_t getCountsIndex(uint64_t value) const;
+        uint64_t getHighestEquivalentValue(std::size_t countsIndex) const;
+
+        uint64_t highestTrackableValue;
+        unsigned subBucketHalfCountMagnitude;
+        uint64_t subBucketHalfCount;
+        uint64_t subBucketMask;
+
+        std::vector<uint64_t> counts;
+
+        uint64_t totalCount = 0;
+        uint64_t minValue = UINT64_MAX;
+        uint64_t maxValue = 0;
+        double sum = 0;
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_LATENCYHISTOGRAM_H
@@ -41,6 +41,8 @@
 
 #include "Mqtt.h"
 
+#include "OutputWriter.h"
+
 #include <iot/mqtt/Topic.h>
 #include <iot/mqtt/packets/Connack.h>
 #include <iot/mqtt/packets/Publish.h>
@@ -49,6 +51,8 @@
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 #include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <cstring>
 #include <iterator>
 #include <list>
@@ -69,13 +73,31 @@
 
 #include <nlohmann/json.hpp>
 
-// get current terminal width, fallback to 80
-static int getTerminalWidth() {
-    int termWidth = 80;
+static volatile std::sig_atomic_t terminalResized = 1;
+
+static void onTerminalResized([[maybe_unused]] int signum) {
+    terminalResized = 1;
+}
 
-    struct winsize w;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_col > 0) {
-        termWidth = w.ws_col;
+// get current terminal width, fallback to 80. Queried again only after a SIGWINCH
+static int getTerminalWidth() {
+    static int termWidth = [] {
+        struct sigaction action {};
+        action.sa_handler = onTerminalResized;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGWINCH, &action, nullptr);
+
+        return 80;
+    }();
+
+    if (terminalResized != 0) {
+        terminalResized = 0;
+
+        struct winsize w;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_col > 0) {
+            termWidth = w.ws_col;
+        }
     }
 
     return termWidth;
@@ -145,9 +167,10 @@ std::vector<std::string> static myformat(const std::string& prefix,
         first = false;
     }
 
-    // try parsing as JSON
-    try {
-        auto j = nlohmann::json::parse(message);
+    // try parsing as JSON, without throwing as most payloads of a busy subscription are not JSON
+    const nlohmann::json j = nlohmann::json::parse(message, nullptr, false);
+
+    if (!j.is_discarded()) {
         // pretty‐print with 2-space indent
         std::string pretty = j.dump(2);
         // split into lines
@@ -162,7 +185,7 @@ std::vector<std::string> static myformat(const std::string& prefix,
                 lines.push_back(indent + "│ " + line);
             }
         }
-    } catch (nlohmann::json::parse_error&) {
+    } else {
         // not JSON → wrap text
 
         // break original message on hard newlines and wrap each paragraph
@@ -229,6 +252,7 @@ namespace mqtt::mqttcli::lib {
                const std::string& pubTopic,
                const std::string& pubMessage,
                bool pubRetain,
+               Output output,
                const std::string& sessionStoreFileName)
         : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive, sessionStoreFileName)
         , qoSDefault(qoSDefault)
@@ -242,7 +266,8 @@ namespace mqtt::mqttcli::lib {
         , subTopics(subTopics)
         , pubTopic(pubTopic)
         , pubMessage(pubMessage)
-        , pubRetain(pubRetain) {
+        , pubRetain(pubRetain)
+        , output(output) {
         VLOG(1) << "Client Id: " << clientId;
         VLOG(1) << "  Keep Alive: " << keepAlive;
         VLOG(1) << "  Clean Session: " << cleanSession;
@@ -360,12 +385,34 @@ namespace mqtt::mqttcli::lib {
     }
 
     void Mqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
-        std::string prefix = "MQTT Publish";
-        std::string headLine = publish.getTopic() + " │ QoS: " + std::to_string(static_cast<uint16_t>(publish.getQoS())) +
-                               " │ Retain: " + (publish.getRetain() != 0 ? "true" : "false") +
-                               " │ Dup: " + (publish.getDup() != 0 ? "true" : "false");
-
-        VLOG(0) << formatAsLogString(prefix, headLine, publish.getMessage());
+        switch (output) {
+            case Output::Pretty: {
+                std::string prefix = "MQTT Publish";
+                std::string headLine = publish.getTopic() + " │ QoS: " + std::to_string(static_cast<uint16_t>(publish.getQoS())) +
+                                       " │ Retain: " + (publish.getRetain() != 0 ? "true" : "false") +
+                                       " │ Dup: " + (publish.getDup() != 0 ? "true" : "false");
+
+                VLOG(0) << formatAsLogString(prefix, headLine, publish.getMessage());
+                break;
+            }
+            case Output::Raw:
+                OutputWriter::instance().write(publish.getMessage());
+                OutputWriter::instance().write("\n");
+                break;
+            case Output::NdJson: {
+                const nlohmann::json record = {
+                    {"timestamp",
+                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()},
+                    {"topic", publish.getTopic()},
+                    {"qos", publish.getQoS()},
+                    {"retain", publish.getRetain()},
+                    {"payload", publish.getMessage()}};
+
+                // Binary payloads are not valid UTF-8, invalid bytes are replaced instead of throwing
+                OutputWriter::instance().write(record.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) + "\n");
+                break;
+            }
+        }
     }
 
     void Mqtt::onPuback([[maybe_unused]] const iot::mqtt::packets::Puback& puback) {
@@ -56,6 +56,8 @@ namespace mqtt::mqttcli::lib {
 
     class Mqtt : public iot::mqtt::client::Mqtt {
     public:
+        enum class Output { Pretty, Raw, NdJson };
+
         explicit Mqtt(const std::string& connectionName,
                       const std::string& clientId,
                       uint8_t qoSDefault,
@@ -71,6 +73,7 @@ namespace mqtt::mqttcli::lib {
                       const std::string& pubTopic,
                       const std::string& pubMessage,
                       bool pubRetain = false,
+                      Output output = Output::Pretty,
                       const std::string& sessionStoreFileName = "");
 
     private:
@@ -99,6 +102,8 @@ namespace mqtt::mqttcli::lib {
         const std::string pubTopic;
         const std::string pubMessage;
         const bool pubRetain;
+
+        const Output output;
     };
 
 } // namespace mqtt::mqttcli::lib
@@ -0,0 +1,179 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "MqttFactory.h"
+
+#include "Bench.h"
+#include "BenchMqtt.h"
+#include "BulkMqtt.h"
+#include "Capture.h"
+#include "ConfigSections.h"
+#include "Mqtt.h"
+#include "ProbeMqtt.h"
+#include "RecordMqtt.h"
+#include "ReplayMqtt.h"
+
+#include <net/config/ConfigInstance.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <unistd.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    iot::mqtt::client::Mqtt* createMqtt(const std::string& connectionName, net::config::ConfigInstance* configInstance) {
+        const ConfigSession* configSession = configInstance->getSubCommand<ConfigSession>();
+        const ConfigBench* configBench = configInstance->getSubCommand<ConfigBench>();
+        const ConfigRecord* configRecord = configInstance->getSubCommand<ConfigRecord>();
+        const ConfigReplay* configReplay = configInstance->getSubCommand<ConfigReplay>();
+        const ConfigBulk* configBulk = configInstance->getSubCommand<ConfigBulk>();
+        const ConfigProbe* configProbe = configInstance->getSubCommand<ConfigProbe>();
+
+        iot::mqtt::client::Mqtt* mqtt = nullptr;
+
+        if (!configBench->getTopic().empty()) {
+            Bench::instance().setParameters({.topicPattern = configBench->getTopic(),
+                                             .publishers = configBench->getPublishers(),
+                                             .subscribers = configBench->getSubscribers(),
+                                             .rate = configBench->getRate(),
+                                             .payloadSize = configBench->getPayloadSize(),
+                                             .topics = configBench->getTopics(),
+                                             .duration = configBench->getDuration(),
+                                             .qoS = configSession->getQoS(),
+                                             .json = configBench->getOutput() == "json"});
+
+            // Every bench connection needs its own client id
+            static std::size_t benchConnectionCount = 0;
+            const std::string clientId = (configSession->getClientId().empty() ? "mqttcli" : configSession->getClientId()) + "-bench-" +
+                                         std::to_string(getpid()) + "-" + std::to_string(benchConnectionCount++);
+
+            mqtt = new BenchMqtt(connectionName,
+                                 clientId,
+                                 configSession->getKeepAlive(),
+                                 configSession->getUsername(),
+                                 configSession->getPassword());
+        } else if (!configRecord->getFile().empty()) {
+            // One capture file per instance, continued across reconnects
+            static std::map<std::string, std::shared_ptr<CaptureWriter>> captureWriters;
+
+            std::shared_ptr<CaptureWriter>& captureWriter = captureWriters[configRecord->getFile()];
+            if (captureWriter == nullptr) {
+                captureWriter = std::make_shared<CaptureWriter>(configRecord->getFile(), configRecord->getIndex());
+            }
+
+            mqtt = new RecordMqtt(connectionName,
+                                  configSession->getClientId(),
+                                  configSession->getKeepAlive(),
+                                  configSession->getUsername(),
+                                  configSession->getPassword(),
+                                  configSession->getQoS(),
+                                  configRecord->getTopic(),
+                                  captureWriter);
+        } else if (!configReplay->getFile().empty()) {
+            mqtt = new ReplayMqtt(connectionName,
+                                  configSession->getClientId(),
+                                  configSession->getKeepAlive(),
+                                  configSession->getUsername(),
+                                  configSession->getPassword(),
+                                  configReplay->getFile(),
+                                  configReplay->getSpeed(),
+                                  configReplay->getStart(),
+                                  configReplay->getRemap(),
+                                  configReplay->getLoop());
+        } else if (!configBulk->getFile().empty()) {
+            mqtt = new BulkMqtt(connectionName,
+                                configSession->getClientId(),
+                                configSession->getKeepAlive(),
+                                configSession->getUsername(),
+                                configSession->getPassword(),
+                                configSession->getQoS(),
+                                configBulk->getFile(),
+                                configBulk->getFormat() == "ndjson" ? BulkMqtt::Format::NdJson : BulkMqtt::Format::Tsv,
+                                configBulk->getWindow(),
+                                configBulk->getRetain());
+        } else if (!configProbe->getTopic().empty()) {
+            mqtt = new ProbeMqtt(connectionName,
+                                 configSession->getClientId(),
+                                 configSession->getKeepAlive(),
+                                 configSession->getUsername(),
+                                 configSession->getPassword(),
+                                 configSession->getQoS(),
+                                 configProbe->getTopic(),
+                                 configProbe->getResultTopic(),
+                                 configProbe->getInterval(),
+                                 configProbe->getTimeout(),
+                                 configProbe->getReportInterval(),
+                                 configProbe->getWindow(),
+                                 configProbe->getOutput() == "json");
+        } else {
+            const ConfigSubscribe* configSubscribe = configInstance->getSubCommand<ConfigSubscribe>();
+            const ConfigPublish* configPublish = configInstance->getSubCommand<ConfigPublish>();
+
+            mqtt = new Mqtt(connectionName,
+                            configSession->getClientId(),
+                            configSession->getQoS(),
+                            configSession->getKeepAlive(),
+                            !configSession->getRetainSession(),
+                            configSession->getWillTopic(),
+                            configSession->getWillMessage(),
+                            configSession->getWillQoS(),
+                            configSession->getWillRetain(),
+                            configSession->getUsername(),
+                            configSession->getPassword(),
+                            configSubscribe->getTopic(),
+                            configPublish->getTopic(),
+                            configPublish->getMessage(),
+                            configPublish->getRetain(),
+                            configSubscribe->getOutput() == "raw"      ? Mqtt::Output::Raw
+                            : configSubscribe->getOutput() == "ndjson" ? Mqtt::Output::NdJson
+                                                                       : Mqtt::Output::Pretty);
+        }
+
+        return mqtt;
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,101 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "OutputWriter.h"
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cerrno>
+#include <unistd.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    OutputWriter::~OutputWriter() {
+        flush();
+    }
+
+    OutputWriter& OutputWriter::instance() {
+        static OutputWriter outputWriter;
+
+        return outputWriter;
+    }
+
+    void OutputWriter::write(std::string_view record) {
+        if (buffer.capacity() < capacity) {
+            buffer.reserve(capacity);
+        }
+
+        buffer.append(record);
+
+        if (buffer.size() >= capacity) {
+            flush();
+        } else if (!flushScheduled) {
+            flushScheduled = true;
+
+            flushTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    flushScheduled = false;
+                    flush();
+                },
+                0);
+        }
+    }
+
+    void OutputWriter::flush() {
+        std::size_t written = 0;
+
+        while (written < buffer.size()) {
+            const ssize_t ret = ::write(STDOUT_FILENO, buffer.data() + written, buffer.size() - written);
+
+            if (ret > 0) {
+                written += static_cast<std::size_t>(ret);
+            } else if (ret < 0 && errno != EINTR) {
+                break; // Output closed, the records are dropped
+            }
+        }
+
+        buffer.clear();
+    }
+
+} // namespace mqtt::mqttcli::lib
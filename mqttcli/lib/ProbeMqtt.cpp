@@ -0,0 +1,251 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "ProbeMqtt.h"
+
+#include <iot/mqtt/Topic.h>
+#include <iot/mqtt/packets/Connack.h>
+#include <iot/mqtt/packets/Publish.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <log/Logger.h>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+#include <utils/system/signal.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    ProbeMqtt::ProbeMqtt(const std::string& connectionName,
+                         const std::string& clientId,
+                         uint16_t keepAlive,
+                         const std::string& username,
+                         const std::string& password,
+                         uint8_t qoS,
+                         const std::string& topic,
+                         const std::string& resultTopic,
+                         double interval,
+                         double timeout,
+                         double reportInterval,
+                         std::size_t window,
+                         bool json)
+        : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive)
+        , username(username)
+        , password(password)
+        , qoS(qoS)
+        , topic(topic)
+        , resultTopic(resultTopic)
+        , interval(interval)
+        , timeout(timeout)
+        , reportInterval(reportInterval)
+        , json(json)
+        , probeId(std::to_string(getpid()) + "-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))
+        , slots(window) {
+        VLOG(1) << "Client Id: " << clientId;
+        VLOG(1) << "  Probe: " << topic << " -> " << resultTopic;
+    }
+
+    ProbeMqtt::~ProbeMqtt() {
+        probeTimer.cancel();
+        reportTimer.cancel();
+    }
+
+    void ProbeMqtt::onConnected() {
+        VLOG(1) << "MQTT: Initiating Session";
+
+        sendConnect(true, "", "", 0, false, username, password);
+    }
+
+    void ProbeMqtt::onDisconnected() {
+        probeTimer.cancel();
+        reportTimer.cancel();
+
+        VLOG(1) << "MQTT: Disconnected";
+    }
+
+    bool ProbeMqtt::onSignal(int signum) {
+        VLOG(1) << "MQTT: On Exit due to '" << strsignal(signum) << "' (SIG" << utils::system::sigabbrev_np(signum) << " = " << signum
+                << ")";
+
+        report();
+
+        sendDisconnect();
+
+        return Super::onSignal(signum);
+    }
+
+    void ProbeMqtt::onConnack(const iot::mqtt::packets::Connack& connack) {
+        if (connack.getReturnCode() == 0) {
+            sendSubscribe({iot::mqtt::Topic(resultTopic, qoS)});
+        } else {
+            sendDisconnect();
+        }
+    }
+
+    void ProbeMqtt::onSuback([[maybe_unused]] const iot::mqtt::packets::Suback& suback) {
+        // Probing starts once the result topic is subscribed, otherwise the first probes would count as lost
+        probeTimer = core::timer::Timer::intervalTimer(
+            [this] {
+                sendProbe();
+            },
+            interval);
+
+        reportTimer = core::timer::Timer::intervalTimer(
+            [this] {
+                report();
+
+                currentSlot = (currentSlot + 1) % slots.size();
+                slots[currentSlot] = Slot();
+            },
+            reportInterval);
+
+        sendProbe();
+    }
+
+    void ProbeMqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        // Only the sequence number needs to survive a mapping on the way back, the send time is kept locally
+        const nlohmann::json probe = nlohmann::json::parse(publish.getMessage(), nullptr, false);
+
+        if (probe.is_object() && probe.contains("seq") && probe["seq"].is_number_unsigned() &&
+            probe.value("probe", probeId) == probeId) {
+            const uint64_t seq = probe["seq"];
+            Slot& slot = slots[currentSlot];
+
+            const auto it = outstanding.find(seq);
+            if (it != outstanding.end()) {
+                slot.latencies.record(
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - it->second).count()));
+                slot.received++;
+
+                if (anyReceived && seq < highestReceived) {
+                    slot.reordered++;
+                }
+
+                outstanding.erase(it);
+            } else {
+                slot.late++;
+            }
+
+            if (!anyReceived || seq > highestReceived) {
+                highestReceived = seq;
+                anyReceived = true;
+            }
+        }
+    }
+
+    void ProbeMqtt::sendProbe() {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        expireProbes(now);
+
+        const nlohmann::json probe = {
+            {"probe", probeId},
+            {"seq", sequence},
+            {"ts",
+             std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()}};
+
+        outstanding.emplace(sequence++, now);
+        slots[currentSlot].sent++;
+
+        sendPublish(topic, probe.dump(), qoS, false);
+    }
+
+    void ProbeMqtt::expireProbes(std::chrono::steady_clock::time_point now) {
+        // Probes are sent in sequence order, thus the oldest outstanding probe comes first
+        while (!outstanding.empty() && now - outstanding.begin()->second > timeout) {
+            outstanding.erase(outstanding.begin());
+            slots[currentSlot].lost++;
+        }
+    }
+
+    void ProbeMqtt::report() {
+        expireProbes(std::chrono::steady_clock::now());
+
+        Slot total;
+        for (const Slot& slot : slots) {
+            total.latencies.add(slot.latencies);
+            total.sent += slot.sent;
+            total.received += slot.received;
+            total.lost += slot.lost;
+            total.reordered += slot.reordered;
+            total.late += slot.late;
+        }
+
+        const double loss =
+            total.received + total.lost > 0 ? 100. * static_cast<double>(total.lost) / static_cast<double>(total.received + total.lost) : 0;
+
+        if (json) {
+            nlohmann::json result;
+
+            result["window"] = static_cast<double>(slots.size()) * reportInterval;
+            result["sent"] = total.sent;
+            result["received"] = total.received;
+            result["lost"] = total.lost;
+            result["loss_percent"] = loss;
+            result["reordered"] = total.reordered;
+            result["late"] = total.late;
+            result["outstanding"] = outstanding.size();
+            result["rtt_us"] = {{"min", total.latencies.getMin()},
+                                {"mean", total.latencies.getMean()},
+                                {"p50", total.latencies.getValueAtPercentile(50)},
+                                {"p90", total.latencies.getValueAtPercentile(90)},
+                                {"p99", total.latencies.getValueAtPercentile(99)},
+                                {"max", total.latencies.getMax()}};
+
+            std::cout << result.dump() << std::endl;
+        } else {
+            VLOG(0) << "MQTT Probe: last " << static_cast<double>(slots.size()) * reportInterval << " seconds: " << total.sent
+                    << " sent, " << total.received << " received, " << total.lost << " lost (" << loss << " %), " << total.reordered
+                    << " reordered, " << total.late << " late";
+            VLOG(0) << "  RTT: p50 " << total.latencies.getValueAtPercentile(50) << " us, p90 " << total.latencies.getValueAtPercentile(90)
+                    << " us, p99 " << total.latencies.getValueAtPercentile(99) << " us, max " << total.latencies.getMax() << " us";
+        }
+    }
+
+} // namespace mqtt::mqttcli::lib
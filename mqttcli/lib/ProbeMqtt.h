@@ -0,0 +1,133 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_PROBEMQTT_H
+#define MQTTCLI_LIB_PROBEMQTT_H
+
+#include "LatencyHistogram.h"
+
+#include <core/timer/Timer.h>
+#include <iot/mqtt/client/Mqtt.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Round-trip probe: publishes sequence numbered probes and measures the time until they come back on the result topic, either
+    // directly or after traversing a mapping. Statistics cover the last window report intervals.
+    class ProbeMqtt : public iot::mqtt::client::Mqtt {
+    public:
+        explicit ProbeMqtt(const std::string& connectionName,
+                           const std::string& clientId,
+                           uint16_t keepAlive,
+                           const std::string& username,
+                           const std::string& password,
+                           uint8_t qoS,
+                           const std::string& topic,
+                           const std::string& resultTopic,
+                           double interval,
+                           double timeout,
+                           double reportInterval,
+                           std::size_t window,
+                           bool json);
+
+        ~ProbeMqtt() override;
+
+    private:
+        using Super = iot::mqtt::client::Mqtt;
+
+        struct Slot {
+            LatencyHistogram latencies;
+            uint64_t sent = 0;
+            uint64_t received = 0;
+            uint64_t lost = 0;
+            uint64_t reordered = 0;
+            uint64_t late = 0; // Duplicates and probes arriving after their timeout
+        };
+
+        void onConnected() final;
+        void onDisconnected() final;
+        [[nodiscard]] bool onSignal(int signum) final;
+
+        void onConnack(const iot::mqtt::packets::Connack& connack) final;
+        void onSuback(const iot::mqtt::packets::Suback& suback) final;
+        void onPublish(const iot::mqtt::packets::Publish& publish) final;
+
+        void sendProbe();
+        void expireProbes(std::chrono::steady_clock::time_point now);
+        void report();
+
+        const std::string username;
+        const std::string password;
+        const uint8_t qoS;
+        const std::string topic;
+        const std::string resultTopic;
+        const double interval;
+        const std::chrono::duration<double> timeout;
+        const double reportInterval;
+        const bool json;
+        const std::string probeId; // Tells our probes apart from those of other probe instances on the same topic
+
+        std::map<uint64_t, std::chrono::steady_clock::time_point> outstanding; // Sequence number -> send time
+        uint64_t sequence = 0;
+        uint64_t highestReceived = 0;
+        bool anyReceived = false;
+
+        std::vector<Slot> slots;
+        std::size_t currentSlot = 0;
+
+        core::timer::Timer probeTimer;
+        core::timer::Timer reportTimer;
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_PROBEMQTT_H
@@ -0,0 +1,122 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "RecordMqtt.h"
+
+#include <iot/mqtt/Topic.h>
+#include <iot/mqtt/packets/Connack.h>
+#include <iot/mqtt/packets/Publish.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstring>
+#include <log/Logger.h>
+#include <utils/system/signal.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    RecordMqtt::RecordMqtt(const std::string& connectionName,
+                           const std::string& clientId,
+                           uint16_t keepAlive,
+                           const std::string& username,
+                           const std::string& password,
+                           uint8_t qoS,
+                           const std::list<std::string>& topics,
+                           const std::shared_ptr<CaptureWriter>& captureWriter)
+        : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive)
+        , username(username)
+        , password(password)
+        , qoS(qoS)
+        , topics(topics)
+        , captureWriter(captureWriter) {
+        VLOG(1) << "Client Id: " << clientId;
+    }
+
+    void RecordMqtt::onConnected() {
+        VLOG(1) << "MQTT: Initiating Session";
+
+        sendConnect(true, "", "", 0, false, username, password);
+    }
+
+    void RecordMqtt::onDisconnected() {
+        captureWriter->flush();
+
+        VLOG(0) << "MQTT Record: " << recorded << " messages captured";
+    }
+
+    bool RecordMqtt::onSignal(int signum) {
+        VLOG(1) << "MQTT: On Exit due to '" << strsignal(signum) << "' (SIG" << utils::system::sigabbrev_np(signum) << " = " << signum
+                << ")";
+
+        sendDisconnect();
+
+        return Super::onSignal(signum);
+    }
+
+    void RecordMqtt::onConnack(const iot::mqtt::packets::Connack& connack) {
+        if (connack.getReturnCode() == 0 && captureWriter->isOpen()) {
+            std::list<iot::mqtt::Topic> topicList;
+            for (const std::string& topic : topics) {
+                VLOG(0) << "  t: " << static_cast<int>(qoS) << " | " << topic;
+
+                topicList.emplace_back(topic, qoS);
+            }
+
+            sendSubscribe(topicList);
+        } else {
+            sendDisconnect();
+        }
+    }
+
+    void RecordMqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
+        const uint64_t timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+        captureWriter->append(timestamp, publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+
+        recorded++;
+    }
+
+} // namespace mqtt::mqttcli::lib
@@ -0,0 +1,94 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_RECORDMQTT_H
+#define MQTTCLI_LIB_RECORDMQTT_H
+
+#include "Capture.h"
+
+#include <iot/mqtt/client/Mqtt.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Captures the messages of the subscribed topics into a capture file
+    class RecordMqtt : public iot::mqtt::client::Mqtt {
+    public:
+        explicit RecordMqtt(const std::string& connectionName,
+                            const std::string& clientId,
+                            uint16_t keepAlive,
+                            const std::string& username,
+                            const std::string& password,
+                            uint8_t qoS,
+                            const std::list<std::string>& topics,
+                            const std::shared_ptr<CaptureWriter>& captureWriter);
+
+    private:
+        using Super = iot::mqtt::client::Mqtt;
+
+        void onConnected() final;
+        void onDisconnected() final;
+        [[nodiscard]] bool onSignal(int signum) final;
+
+        void onConnack(const iot::mqtt::packets::Connack& connack) final;
+        void onPublish(const iot::mqtt::packets::Publish& publish) final;
+
+        const std::string username;
+        const std::string password;
+        const uint8_t qoS;
+        const std::list<std::string> topics;
+
+        std::shared_ptr<CaptureWriter> captureWriter; // Shared by the reconnects of an instance
+        uint64_t recorded = 0;
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_RECORDMQTT_H
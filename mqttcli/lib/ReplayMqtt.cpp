@@ -0,0 +1,198 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "ReplayMqtt.h"
+
+#include <core/SNodeC.h>
+#include <iot/mqtt/packets/Connack.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <cstring>
+#include <log/Logger.h>
+#include <utils/system/signal.h>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    ReplayMqtt::ReplayMqtt(const std::string& connectionName,
+                           const std::string& clientId,
+                           uint16_t keepAlive,
+                           const std::string& username,
+                           const std::string& password,
+                           const std::string& path,
+                           double speed,
+                           double start,
+                           const std::list<std::string>& remaps,
+                           bool loop)
+        : iot::mqtt::client::Mqtt(connectionName, clientId, keepAlive)
+        , username(username)
+        , password(password)
+        , speed(speed)
+        , start(start)
+        , loop(loop)
+        , captureReader(path) {
+        VLOG(1) << "Client Id: " << clientId;
+        VLOG(1) << "  Capture File: " << path;
+        VLOG(1) << "  Speed: " << speed;
+
+        for (const std::string& remap : remaps) {
+            const std::size_t pos = remap.find('=');
+
+            if (pos != std::string::npos) {
+                this->remaps.emplace_back(remap.substr(0, pos), remap.substr(pos + 1));
+            } else {
+                VLOG(0) << "[" << Color::Code::FG_RED << "Error" << Color::Code::FG_DEFAULT << "] Malformed remap: " << remap;
+            }
+        }
+    }
+
+    void ReplayMqtt::onConnected() {
+        VLOG(1) << "MQTT: Initiating Session";
+
+        sendConnect(true, "", "", 0, false, username, password);
+    }
+
+    void ReplayMqtt::onDisconnected() {
+        replayTimer.cancel();
+
+        VLOG(0) << "MQTT Replay: " << replayed << " messages replayed";
+
+        // Not reconnected, a new connection would replay the capture once more
+        if (finished) {
+            core::SNodeC::stop();
+        }
+    }
+
+    bool ReplayMqtt::onSignal(int signum) {
+        VLOG(1) << "MQTT: On Exit due to '" << strsignal(signum) << "' (SIG" << utils::system::sigabbrev_np(signum) << " = " << signum
+                << ")";
+
+        sendDisconnect();
+
+        return Super::onSignal(signum);
+    }
+
+    void ReplayMqtt::onConnack(const iot::mqtt::packets::Connack& connack) {
+        if (connack.getReturnCode() == 0 && captureReader.isOpen()) {
+            startPass();
+        } else {
+            finished = true;
+
+            sendDisconnect();
+        }
+    }
+
+    void ReplayMqtt::startPass() {
+        captureReader.rewind();
+
+        hasPending = captureReader.next(pending);
+
+        if (hasPending && start > 0) {
+            captureReader.seek(pending.timestamp + static_cast<uint64_t>(start * 1e9));
+            hasPending = captureReader.next(pending);
+        }
+
+        passStartTimestamp = pending.timestamp;
+        passStartTimePoint = std::chrono::steady_clock::now();
+
+        replayDue();
+    }
+
+    void ReplayMqtt::replayDue() {
+        uint64_t burst = 0;
+        double delay = 0;
+
+        for (; hasPending && burst < maxBurst; burst++) {
+            if (speed > 0) {
+                const uint64_t captureOffset = pending.timestamp > passStartTimestamp ? pending.timestamp - passStartTimestamp : 0;
+                const double dueIn = static_cast<double>(captureOffset) / 1e9 / speed -
+                                     std::chrono::duration<double>(std::chrono::steady_clock::now() - passStartTimePoint).count();
+
+                if (dueIn > 0) {
+                    delay = dueIn;
+                    break;
+                }
+            }
+
+            sendPublish(remap(pending.topic), std::string(pending.payload), pending.qoS, pending.retain);
+            replayed++;
+
+            hasPending = captureReader.next(pending);
+        }
+
+        if (hasPending) {
+            replayTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    replayDue();
+                },
+                delay);
+        } else if (loop && replayed > 0) {
+            replayTimer = core::timer::Timer::singleshotTimer(
+                [this] {
+                    startPass();
+                },
+                0);
+        } else {
+            VLOG(0) << "MQTT Replay: Finished";
+
+            finished = true;
+
+            sendDisconnect();
+        }
+    }
+
+    std::string ReplayMqtt::remap(std::string_view topic) const {
+        std::string remappedTopic(topic);
+
+        for (const auto& [prefix, replacement] : remaps) {
+            if (topic.starts_with(prefix)) {
+                remappedTopic = replacement + std::string(topic.substr(prefix.size()));
+                break;
+            }
+        }
+
+        return remappedTopic;
+    }
+
+} // namespace mqtt::mqttcli::lib
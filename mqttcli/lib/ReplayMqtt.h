@@ -0,0 +1,113 @@
+/*
+ * MQTTSuite - A lightweight MQTT Integration System
+ * Copyright (C) Volker Christian <me@vchrist.at>
+ *               2022, 2023, 2024, 2025, 2026
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MQTTCLI_LIB_REPLAYMQTT_H
+#define MQTTCLI_LIB_REPLAYMQTT_H
+
+#include "Capture.h"
+
+#include <core/timer/Timer.h>
+#include <iot/mqtt/client/Mqtt.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#endif
+
+namespace mqtt::mqttcli::lib {
+
+    // Republishes a capture file with the original inter-arrival times scaled by the speed, or as fast as possible for speed 0
+    class ReplayMqtt : public iot::mqtt::client::Mqtt {
+    public:
+        explicit ReplayMqtt(const std::string& connectionName,
+                            const std::string& clientId,
+                            uint16_t keepAlive,
+                            const std::string& username,
+                            const std::string& password,
+                            const std::string& path,
+                            double speed,
+                            double start,
+                            const std::list<std::string>& remaps,
+                            bool loop);
+
+    private:
+        using Super = iot::mqtt::client::Mqtt;
+
+        void onConnected() final;
+        void onDisconnected() final;
+        [[nodiscard]] bool onSignal(int signum) final;
+
+        void onConnack(const iot::mqtt::packets::Connack& connack) final;
+
+        void startPass();
+        void replayDue();
+        std::string remap(std::string_view topic) const;
+
+        const std::string username;
+        const std::string password;
+        const double speed;
+        const double start;
+        const bool loop;
+        std::vector<std::pair<std::string, std::string>> remaps; // Topic prefix and its replacement
+
+        CaptureReader captureReader;
+        CaptureReader::Record pending;
+        bool hasPending = false;
+        uint64_t passStartTimestamp = 0;
+        std::chrono::steady_clock::time_point passStartTimePoint;
+        uint64_t replayed = 0;
+        bool finished = false;
+
+        core::timer::Timer replayTimer;
+
+        static constexpr uint64_t maxBurst = 1000; // Publishes per event loop iteration
+    };
+
+} // namespace mqtt::mqttcli::lib
+
+#endif // MQTTCLI_LIB_REPLAYMQTT_H
@@ -79,10 +79,15 @@
 
 #include <log/Logger.h>
 //
+#include <cstddef>
 #include <list>
+#include <set>
+#include <string>
 
 #endif
 
+static std::set<std::string> benchInstances;
+
 static void
 reportState(const std::string& instanceName, const core::socket::SocketAddress& socketAddress, const core::socket::State& state) {
     switch (state) {
@@ -116,6 +121,33 @@ static void logResponse(const std::shared_ptr<web::http::client::Request>& req,
             << httputils::toString(res->httpVersion, res->statusCode, res->reason, res->headers, res->cookies, res->body);
 }
 
+// The load generator opens all further connections of an instance once the first one has been established
+template <typename Client>
+static void connectBenchClients(Client client, const std::string& instanceName, const core::socket::State& state) {
+    using SocketAddress = typename Client::SocketAddress;
+
+    const mqtt::mqttcli::lib::ConfigBench* configBench = client.getConfig()->template getSubCommand<mqtt::mqttcli::lib::ConfigBench>();
+
+    if (state == core::socket::State::OK && !configBench->getTopic().empty() && benchInstances.insert(instanceName).second) {
+        for (std::size_t connection = 1; connection < configBench->getPublishers() + configBench->getSubscribers(); connection++) {
+            client.connect([instanceName](const SocketAddress& socketAddress, const core::socket::State& connectState) {
+                reportState(instanceName, socketAddress, connectState);
+            });
+        }
+    }
+}
+
+// A bench connection coming back finds no role left and disconnects again and a new bulk or replay connection would publish its input
+// once more, thus reconnecting is only kept for the other applications
+template <typename Client>
+static void disableReconnectForRuns(Client client) {
+    if (!client.getConfig()->template getSubCommand<mqtt::mqttcli::lib::ConfigBench>()->getTopic().empty() ||
+        !client.getConfig()->template getSubCommand<mqtt::mqttcli::lib::ConfigBulk>()->getFile().empty() ||
+        !client.getConfig()->template getSubCommand<mqtt::mqttcli::lib::ConfigReplay>()->getFile().empty()) {
+        client.getConfig()->setReconnect(false);
+    }
+}
+
 template <template <typename SocketContextFactoryT, typename... ArgsT> typename SocketClient>
 static SocketClient<mqtt::mqttcli::SocketContextFactory>
 startClient(const std::string& instanceName,
@@ -130,8 +162,11 @@ startClient(const std::string& instanceName,
     socketClient.getConfig()->setReconnect();
     socketClient.getConfig()->setDisabled();
 
-    socketClient.connect([instanceName](const SocketAddress& socketAddress, const core::socket::State& state) {
+    socketClient.connect([instanceName, socketClient](const SocketAddress& socketAddress, const core::socket::State& state) {
         reportState(instanceName, socketAddress, state);
+
+        disableReconnectForRuns(socketClient);
+        connectBenchClients(socketClient, instanceName, state);
     });
 
     return socketClient;
@@ -194,8 +229,11 @@ static HttpClient startClient(const std::string& name, const std::function<void(
     httpClient.getConfig()->setReconnect();
     httpClient.getConfig()->setDisabled();
 
-    httpClient.connect([name](const SocketAddress& socketAddress, const core::socket::State& state) {
+    httpClient.connect([name, httpClient](const SocketAddress& socketAddress, const core::socket::State& state) {
         reportState(name, socketAddress, state);
+
+        disableReconnectForRuns(httpClient);
+        connectBenchClients(httpClient, name, state);
     });
 
     return httpClient;
@@ -205,16 +243,27 @@ static void createConfig(net::config::ConfigInstance* config) {
     config->newSubCommand<mqtt::mqttcli::lib::ConfigSession>();
     config->newSubCommand<mqtt::mqttcli::lib::ConfigSubscribe>();
     config->newSubCommand<mqtt::mqttcli::lib::ConfigPublish>();
+    config->newSubCommand<mqtt::mqttcli::lib::ConfigBench>();
+    config->newSubCommand<mqtt::mqttcli::lib::ConfigRecord>();
+    config->newSubCommand<mqtt::mqttcli::lib::ConfigReplay>();
+    config->newSubCommand<mqtt::mqttcli::lib::ConfigBulk>();
+    config->newSubCommand<mqtt::mqttcli::lib::ConfigProbe>();
 
     config->setRequireCallback([config]() {
         if (!config->getDisabled() && config->getShowConfigTriggerApp() == nullptr &&
             config->getParent()->getOption("--write-config")->count() == 0) {
             const mqtt::mqttcli::lib::ConfigPublish* pubApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigPublish>();
             const mqtt::mqttcli::lib::ConfigSubscribe* subApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigSubscribe>();
-
-            if (pubApp->getTopic().empty() && subApp->getTopic().empty()) {
+            const mqtt::mqttcli::lib::ConfigBench* benchApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigBench>();
+            const mqtt::mqttcli::lib::ConfigRecord* recordApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigRecord>();
+            const mqtt::mqttcli::lib::ConfigReplay* replayApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigReplay>();
+            const mqtt::mqttcli::lib::ConfigBulk* bulkApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigBulk>();
+            const mqtt::mqttcli::lib::ConfigProbe* probeApp = config->getSubCommand<mqtt::mqttcli::lib::ConfigProbe>();
+
+            if (pubApp->getTopic().empty() && subApp->getTopic().empty() && benchApp->getTopic().empty() && recordApp->getFile().empty() &&
+                replayApp->getFile().empty() && bulkApp->getFile().empty() && probeApp->getTopic().empty()) {
                 throw CLI::RequiresError(config->getParent()->getName() + ":" + config->getInstanceName() +
-                                             " requires at least one of {sub | pub}",
+                                             " requires at least one of {sub | pub | bench | record | replay | bulk | probe}",
                                          CLI::ExitCodes::RequiresError);
             }
 
@@ -227,6 +276,31 @@ static void createConfig(net::config::ConfigInstance* config) {
                 VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
                         << config->getInstanceName() << ":sub";
             }
+
+            if (!benchApp->getTopic().empty()) {
+                VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
+                        << config->getInstanceName() << ":bench";
+            }
+
+            if (!recordApp->getFile().empty()) {
+                VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
+                        << config->getInstanceName() << ":record";
+            }
+
+            if (!replayApp->getFile().empty()) {
+                VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
+                        << config->getInstanceName() << ":replay";
+            }
+
+            if (!bulkApp->getFile().empty()) {
+                VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
+                        << config->getInstanceName() << ":bulk";
+            }
+
+            if (!probeApp->getTopic().empty()) {
+                VLOG(0) << "[" << Color::Code::FG_LIGHT_GREEN << "Success" << Color::Code::FG_DEFAULT << "] " << "Bootstrap of "
+                        << config->getInstanceName() << ":probe";
+            }
         }
     });
 }
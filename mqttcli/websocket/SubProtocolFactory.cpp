@@ -41,10 +41,10 @@
 
 #include "SubProtocolFactory.h"
 
-#include "lib/ConfigSections.h"
-#include "lib/Mqtt.h"
+#include "lib/MqttFactory.h"
 
 #include <core/socket/stream/SocketConnection.h>
+#include <iot/mqtt/client/Mqtt.h>
 #include <net/config/ConfigInstance.h>
 #include <web/websocket/SubProtocolContext.h>
 
@@ -61,31 +61,11 @@ namespace mqtt::mqttcli::websocket {
     }
 
     iot::mqtt::client::SubProtocol* SubProtocolFactory::create(web::websocket::SubProtocolContext* subProtocolContext) {
-        const lib::ConfigSession* configSession =
-            subProtocolContext->getSocketConnection()->getConfigInstance()->getSubCommand<lib::ConfigSession>();
-        const lib::ConfigSubscribe* configSubscribe =
-            subProtocolContext->getSocketConnection()->getConfigInstance()->getSubCommand<lib::ConfigSubscribe>();
-        const lib::ConfigPublish* configPublish =
-            subProtocolContext->getSocketConnection()->getConfigInstance()->getSubCommand<lib::ConfigPublish>();
-
         return new iot::mqtt::client::SubProtocol(
             subProtocolContext,
             getName(),
-            new ::mqtt::mqttcli::lib::Mqtt(subProtocolContext->getSocketConnection()->getConnectionName(),
-                                           configSession->getClientId(),
-                                           configSession->getQoS(),
-                                           configSession->getKeepAlive(),
-                                           !configSession->getRetainSession(),
-                                           configSession->getWillTopic(),
-                                           configSession->getWillMessage(),
-                                           configSession->getWillQoS(),
-                                           configSession->getWillRetain(),
-                                           configSession->getUsername(),
-                                           configSession->getPassword(),
-                                           configSubscribe->getTopic(),
-                                           configPublish->getTopic(),
-                                           configPublish->getMessage(),
-                                           configPublish->getRetain()));
+            lib::createMqtt(subProtocolContext->getSocketConnection()->getConnectionName(),
+                            subProtocolContext->getSocketConnection()->getConfigInstance()));
     }
 
 } // namespace mqtt::mqttcli::websocket
@@ -44,6 +44,7 @@
 #include "Mqtt.h"
 
 #include "lib/MappingAdminRouter.h"
+#include "lib/Metrics.h"
 #include "lib/MqttMapper.h"
 
 #include <iot/mqtt/Topic.h>
@@ -53,6 +54,7 @@
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 
 #endif
@@ -109,6 +111,12 @@ namespace mqtt::mqttintegrator::lib {
         return reloadResult;
     }
 
+    void Mqtt::publishAggregate(const iot::mqtt::packets::Publish& publish) {
+        for (Mqtt* mqtt : mqttInstances) {
+            mqtt->sendPublish(publish.getTopic(), publish.getMessage(), publish.getQoS(), publish.getRetain());
+        }
+    }
+
     void Mqtt::onConnected() {
         const auto& [cleanSession, //
                      willTopic,
@@ -132,7 +140,17 @@ namespace mqtt::mqttintegrator::lib {
         }
     }
 
+    static mqtt::lib::metrics::Counter& publishReceived = mqtt::lib::metrics::Registry::instance().counter(
+        "mqttsuite_integrator_publish_received_total", "Publishes received from the broker");
+    static mqtt::lib::metrics::Histogram& publishDuration = mqtt::lib::metrics::Registry::instance().histogram(
+        "mqttsuite_integrator_publish_duration_seconds", "Time spent handling a received publish including its mappings");
+    static mqtt::lib::metrics::Gauge& delayedQueueDepth = mqtt::lib::metrics::Registry::instance().gauge(
+        "mqttsuite_integrator_delayed_queue_depth", "Delayed publishes waiting to be sent");
+
     void Mqtt::onPublish(const iot::mqtt::packets::Publish& publish) {
+        const mqtt::lib::metrics::ScopedDuration scopedDuration(publishDuration);
+        publishReceived.inc();
+
         const auto& [immediatePublishes, scheduledPublishes] = mqttMapper->getMappings(publish);
 
         for (const mqtt::lib::MqttMapper::ScheduledPublish& delayedPublish : scheduledPublishes) {
@@ -197,6 +215,8 @@ namespace mqtt::mqttintegrator::lib {
 
     Mqtt::DelayedQueue::~DelayedQueue() {
         delayTimer.cancel();
+
+        delayedQueueDepth.add(-static_cast<std::int64_t>(minHeap.size()));
     }
 
     void Mqtt::DelayedQueue::processDue() {
@@ -205,6 +225,7 @@ namespace mqtt::mqttintegrator::lib {
         while (!empty() && top().when <= now) {
             const iot::mqtt::packets::Publish duePublish = top().publish;
             pop();
+            delayedQueueDepth.add(-1);
 
             mqtt->sendPublish(duePublish.getTopic(), duePublish.getMessage(), duePublish.getQoS(), duePublish.getRetain());
         }
@@ -231,6 +252,8 @@ namespace mqtt::mqttintegrator::lib {
 
     void Mqtt::DelayedQueue::delayPublish(const utils::Timeval& delay, const iot::mqtt::packets::Publish& publish) {
         minHeap.emplace(utils::Timeval::currentTime() + delay, nextSeq++, publish, delay);
+        delayedQueueDepth.add(1);
+
         armDelayTimer();
     }
 
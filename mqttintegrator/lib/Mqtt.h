@@ -83,6 +83,7 @@ namespace mqtt::mqttintegrator::lib {
 
         ~Mqtt() override;
         static mqtt::lib::admin::ReloadResult updateSubscriptions(bool mustReconnect);
+        static void publishAggregate(const iot::mqtt::packets::Publish& publish);
 
     private:
         using Super = iot::mqtt::client::Mqtt;
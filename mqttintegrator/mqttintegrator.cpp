@@ -90,6 +90,7 @@
 // admin API
 #include "lib/MappingAdminRouter.h"
 #include "lib/Mqtt.h"
+#include "lib/MqttMapper.h"
 
 static void
 reportState(const std::string& instanceName, const core::socket::SocketAddress& socketAddress, const core::socket::State& state) {
@@ -217,6 +218,10 @@ int main(int argc, char* argv[]) {
 
     core::SNodeC::init(argc, argv);
 
+    configMqttIntegrator->getMqttMapper()->setOnAggregate([](const iot::mqtt::packets::Publish& publish) {
+        mqtt::mqttintegrator::lib::Mqtt::publishAggregate(publish);
+    });
+
     // Instanciate Admin Router for Mapping Management
     express::Router router =
         mqtt::lib::admin::makeMappingAdminRouter(configMqttIntegrator, mqtt::lib::admin::AdminOptions{}, [](bool mustReconnect) {
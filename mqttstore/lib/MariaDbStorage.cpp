@@ -11,6 +11,7 @@
 
 #include "MariaDbStorage.h"
 
+#include "lib/Metrics.h"
 #include "lib/MqttMessage.h"
 #include "lib/StoragePlan.h"
 
@@ -89,7 +90,15 @@ namespace mqtt::mqttstore::lib {
         }
     }
 
+    static mqtt::lib::metrics::Counter& messagesStored =
+        mqtt::lib::metrics::Registry::instance().counter("mqttsuite_store_messages_total", "Messages handed to the database");
+    static mqtt::lib::metrics::Histogram& storeDuration = mqtt::lib::metrics::Registry::instance().histogram(
+        "mqttsuite_store_duration_seconds", "Time spent building and queueing the inserts for one message");
+
     void MariaDbStorage::store(const MqttMessage& message) {
+        const mqtt::lib::metrics::ScopedDuration scopedDuration(storeDuration);
+        messagesStored.inc();
+
         const std::optional<nlohmann::json> payloadJson = parsePayload(message.payload);
         const std::string rawInsertSql = buildRawInsertSql(rawTable, message, payloadJson);
 